@@ -0,0 +1,167 @@
+#if !defined(AG_ARENA_H)
+#define AG_ARENA_H
+#include "common.h"
+
+/*
+An arena hands out memory by bumping a pointer through large regions mapped
+straight from the system, asking for huge pages where it can. Nothing is
+freed on its own: `free` does nothing and agnes_arena_reset takes everything
+back at once, keeping the regions for the next parse. Requests larger than a
+region get a mapping of their own, which the reset does release.
+
+The interner only frees what it has replaced (pool arrays and tables it
+grew out of), so with an arena a parse costs a few mmap calls and far fewer
+page faults than the same allocations through malloc.
+*/
+
+#define ARENA_REGION_SIZE MiB(64)
+#define ARENA_ALIGN 64 // a cache line
+
+typedef struct arena_region {
+    struct arena_region *next;
+    size_t size; // of the whole mapping, this header included
+} arena_region_t;
+
+typedef struct agnes_arena {
+    // optional: bytes per region, rounded up to AG_HUGE_PAGE (0 for
+    // ARENA_REGION_SIZE). Read by agnes_arena_init.
+    size_t region_size;
+    // optional: map regions on huge pages (MAP_HUGETLB when the system has
+    // some reserved, else transparent huge pages)
+    bool huge_pages;
+
+    // regions in the order they were mapped; those after `current` are
+    // unused since the last reset
+    arena_region_t *first;
+    arena_region_t *current;
+    u8 *at;
+    u8 *end;
+    arena_region_t *large; // requests larger than a region, one each
+    ag_mutex_t lock;       // allocating is thread-safe
+} agnes_arena_t;
+
+// agnes_arena_init once, then agnes_arena_alloc from any thread, and
+// agnes_arena_reset when nothing allocated so far is used anymore
+static bool agnes_arena_init(agnes_arena_t *arena);
+static bool agnes_arena_alloc(agnes_arena_t *arena, size_t size, u8 **out);
+static void agnes_arena_reset(agnes_arena_t *arena);
+static void agnes_arena_free(agnes_arena_t *arena);
+
+#endif
+
+#if defined(AG_ARENA_IMPLEMENT) && !defined(AG_ARENA_IMPLEMENTED)
+#define AG_ARENA_IMPLEMENTED
+
+#define ARENA_HEADER                                                           \
+    ((sizeof(arena_region_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static size_t round_to_huge_page(size_t size) {
+    return (size + AG_HUGE_PAGE - 1) & ~(size_t)(AG_HUGE_PAGE - 1);
+}
+
+static arena_region_t *map_region(agnes_arena_t *arena, size_t size) {
+    arena_region_t *region = (arena_region_t *)ag_map(size, arena->huge_pages);
+    if (region == NULL) {
+        return NULL;
+    }
+    region->next = NULL;
+    region->size = size;
+    return region;
+}
+
+static void use_region(agnes_arena_t *arena, arena_region_t *region) {
+    arena->current = region;
+    arena->at = (u8 *)region + ARENA_HEADER;
+    arena->end = (u8 *)region + region->size;
+}
+
+bool agnes_arena_init(agnes_arena_t *arena) {
+    arena->region_size = round_to_huge_page(
+        arena->region_size > 0 ? arena->region_size : ARENA_REGION_SIZE);
+    arena->large = NULL;
+    arena->first = map_region(arena, arena->region_size);
+    if (arena->first == NULL) {
+        return false;
+    }
+    use_region(arena, arena->first);
+    ag_mutex_init(&arena->lock);
+    return true;
+}
+
+// Moves on to the next region, mapping it if no reset left one behind.
+static bool next_region(agnes_arena_t *arena) {
+    if (arena->current->next == NULL) {
+        arena_region_t *region = map_region(arena, arena->region_size);
+        if (region == NULL) {
+            return false;
+        }
+        arena->current->next = region;
+    }
+    use_region(arena, arena->current->next);
+    return true;
+}
+
+bool agnes_arena_alloc(agnes_arena_t *arena, size_t size, u8 **out) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size > arena->region_size - ARENA_HEADER) {
+        arena_region_t *region =
+            map_region(arena, round_to_huge_page(ARENA_HEADER + size));
+        if (region == NULL) {
+            return false;
+        }
+        ag_mutex_lock(&arena->lock);
+        region->next = arena->large;
+        arena->large = region;
+        ag_mutex_unlock(&arena->lock);
+        *out = (u8 *)region + ARENA_HEADER;
+        return true;
+    }
+
+    ag_mutex_lock(&arena->lock);
+    if ((size_t)(arena->end - arena->at) < size && !next_region(arena)) {
+        ag_mutex_unlock(&arena->lock);
+        return false;
+    }
+    *out = arena->at;
+    arena->at += size;
+    ag_mutex_unlock(&arena->lock);
+    return true;
+}
+
+// Everything allocated so far becomes invalid, the regions are kept.
+void agnes_arena_reset(agnes_arena_t *arena) {
+    ag_mutex_lock(&arena->lock);
+    while (arena->large != NULL) {
+        arena_region_t *next = arena->large->next;
+        ag_release((u8 *)arena->large, arena->large->size);
+        arena->large = next;
+    }
+    use_region(arena, arena->first);
+    ag_mutex_unlock(&arena->lock);
+}
+
+void agnes_arena_free(agnes_arena_t *arena) {
+    agnes_arena_reset(arena);
+    for (arena_region_t *region = arena->first; region != NULL;) {
+        arena_region_t *next = region->next;
+        ag_release((u8 *)region, region->size);
+        region = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+    ag_mutex_destroy(&arena->lock);
+}
+
+// `allocator_t` takes no context, so the arena that can be passed as one
+// is this global one: agnes_arena_init(&global_arena) first.
+agnes_arena_t global_arena;
+
+static bool global_arena_alloc(size_t size, u8 **out) {
+    return agnes_arena_alloc(&global_arena, size, out);
+}
+
+static void global_arena_free(u8 *ptr) { (void)ptr; }
+
+#define ARENA_ALLOCATOR ((allocator_t){global_arena_alloc, global_arena_free})
+
+#endif
\ No newline at end of file
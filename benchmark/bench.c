@@ -0,0 +1,698 @@
+#define AG_PARSER_IMPLEMENT
+#include "common.h"
+#include "parser.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+static u64 now_ns(void) {
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (u64)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+}
+#else
+#include <time.h>
+static u64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000u + (u64)ts.tv_nsec;
+}
+#endif
+
+bool stupid_alloc(size_t size, u8 **out) {
+    u8 *ptr = (u8 *)malloc(size);
+    if (ptr == NULL) {
+        return false;
+    } else {
+        *out = ptr;
+        return true;
+    }
+}
+
+void stupid_free(u8 *in) { free(in); }
+
+#define RUNS 5
+
+// pretty-printed array of records, roughly what our feeds look like
+static size_t generate_document(u8 *out, size_t target_size) {
+    static char const *names[] = {"Fabienne", "Lucius Domitius Aurelianus",
+                                  "Miguel Angel Asturias", "Saint-Exupery"};
+    size_t at = 0;
+    at += sprintf((char *)out + at, "[\n");
+    for (u32 i = 0; at + 512 < target_size; ++i) {
+        at += sprintf((char *)out + at,
+                      "    {\n"
+                      "        \"Name\": \"%s\",\n"
+                      "        \"Id\": %u,\n"
+                      "        \"Score\": %u.%03u,\n"
+                      "        \"Active\": %s,\n"
+                      "        \"Tags\": [\"a\", \"b\", null],\n"
+                      "        \"Description\": \"Lorem ipsum dolor sit amet, "
+                      "consectetur adipiscing elit, sed do eiusmod tempor "
+                      "incididunt ut labore et dolore magna aliqua\"\n"
+                      "    },\n",
+                      names[i % 4], i, (i * 7919u) % 1000, i % 1000,
+                      (i & 1) ? "true" : "false");
+    }
+    at += sprintf((char *)out + at, "    {}\n]\n");
+    return at;
+}
+
+// the byte-at-a-time loop tokenize() replaced, as a baseline to measure it
+// against (no `stop`, so not for tokenize_parallel)
+static agnes_result_t tokenize_scalar(lexer_t *lexer) {
+    while (lexer->position < lexer->len) {
+        u8 c = consume(lexer);
+        lexer->begin_i = lexer->position - 1;
+
+        switch (c) {
+        case '\n':
+        case ' ':
+        case '\r':
+        case '\t':
+            // ignore whitespace
+            break;
+
+        default: {
+            agnes_result_t res = lex_token(lexer, c);
+            if (res.kind == RES_LEXER_NONE) {
+                return push_eof(lexer);
+            } else if (res.kind != RES_LEXER_SOME) {
+                return res;
+            }
+        } break;
+        }
+    }
+    return end_of_bytes(lexer);
+}
+
+typedef agnes_result_t (*tokenize_fn)(lexer_t *);
+
+static size_t parallel_threads;
+
+static agnes_result_t tokenize_threads(lexer_t *lexer) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    return tokenize_parallel(lexer, parallel_threads, allocator);
+}
+
+static double time_tokenize(tokenize_fn fn, u8 const *bytes, size_t size,
+                            packed_token_t *tokens, size_t max_tokens,
+                            size_t *token_count) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    u64 best = UINT64_MAX;
+
+    for (int run = 0; run < RUNS; ++run) {
+        if (!init_global_interner(&global_string_interner, allocator,
+                                  ATLEAST_PAGE(size))) {
+            panic("unable to initialise interner");
+        }
+
+        lexer_t lexer = {
+            .bytes = bytes,
+            .len = size,
+            .tokens = tokens,
+            .max_tokens = max_tokens,
+            .first_line = 1,
+            .first_column = 1,
+            .interner = &global_string_interner,
+        };
+
+        u64 start = now_ns();
+        agnes_result_t res = fn(&lexer);
+        u64 elapsed = now_ns() - start;
+
+        if (res.kind != RES_LEXER_NONE) {
+            panic("tokenize failed (kind=%d)", res.kind);
+        }
+        *token_count = lexer.next_token;
+        best = elapsed < best ? elapsed : best;
+
+        free_and_invalidate(&global_string_interner);
+    }
+
+    return ((double)size / (1024.0 * 1024.0 * 1024.0)) / ((double)best * 1e-9);
+}
+
+// one record per line, like the generated document without the indentation
+static size_t generate_ndjson(u8 *out, size_t target_size) {
+    size_t at = 0;
+    for (u32 i = 0; at + 512 < target_size; ++i) {
+        at += sprintf((char *)out + at,
+                      "{\"Name\": \"user%u\", \"Id\": %u, \"Score\": %u.%03u, "
+                      "\"Active\": %s, \"Tags\": [\"a\", \"b\", null]}\n",
+                      i % 9973, i, (i * 7919u) % 1000, i % 1000,
+                      (i & 1) ? "true" : "false");
+    }
+    return at;
+}
+
+static double time_ndjson(u8 const *bytes, size_t size, size_t threads,
+                          agnes_result_t *results, size_t max_results) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    u64 best = UINT64_MAX;
+
+    for (int run = 0; run < RUNS; ++run) {
+        agnes_batch_t batch = {
+            .bytes = bytes,
+            .size = size,
+            .string_allocator = allocator,
+            .threads = threads,
+            .results = results,
+            .max_results = max_results,
+        };
+
+        u64 start = now_ns();
+        agnes_result_t res = parse_ndjson(&batch);
+        u64 elapsed = now_ns() - start;
+
+        if (res.kind != RES_NONE) {
+            panic("parse_ndjson failed (kind=%d)", res.kind);
+        }
+        best = elapsed < best ? elapsed : best;
+    }
+
+    return ((double)size / (1024.0 * 1024.0 * 1024.0)) / ((double)best * 1e-9);
+}
+
+// GeoJSON-style coordinate pairs, nearly all of the document is numbers
+static size_t generate_coordinates(u8 *out, size_t target_size) {
+    size_t at = 0;
+    at += sprintf((char *)out + at, "[");
+    for (u32 i = 0; at + 64 < target_size; ++i) {
+        at += sprintf((char *)out + at, "[%.6f,%.6f],",
+                      (double)(i * 7919u % 360000u) / 1000.0 - 180.0,
+                      (double)(i * 104729u % 180000u) / 1000.0 - 90.0);
+    }
+    at += sprintf((char *)out + at, "[0,0]]");
+    return at;
+}
+
+// parse_json() into a tape, numbers converted or kept as text
+static double time_tape(u8 const *bytes, size_t size, packed_token_t *tokens,
+                        size_t max_tokens, u64 *tape, size_t max_tape,
+                        bool raw_numbers) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    u64 best = UINT64_MAX;
+
+    for (int run = 0; run < RUNS; ++run) {
+        agnes_parser_t parser = {
+            .bytes = bytes,
+            .file_size = size,
+            .tokens = tokens,
+            .max_tokens = max_tokens,
+            .string_allocator = allocator,
+            .tape = tape,
+            .max_tape = max_tape,
+            .raw_numbers = raw_numbers,
+        };
+
+        u64 start = now_ns();
+        agnes_result_t res = parse_json(&parser);
+        u64 elapsed = now_ns() - start;
+
+        if (res.kind != RES_PARSER_SOME) {
+            panic("parse_json failed (kind=%d)", res.kind);
+        }
+        best = elapsed < best ? elapsed : best;
+
+        free_and_invalidate(&global_string_interner);
+    }
+
+    return ((double)size / (1024.0 * 1024.0 * 1024.0)) / ((double)best * 1e-9);
+}
+
+#define SMALL_DOCUMENTS 100000
+
+// ns per small document (a request payload, say) parsed to a tape, with
+// parse_json or in a session that is reset after every document
+static double time_small(bool session_parse) {
+    static char const document[] =
+        "{\"id\": 48213, \"user\": \"fabienne\", \"action\": \"update\", "
+        "\"tags\": [\"a\", \"b\"], \"score\": 0.75, \"active\": true}";
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    u64 tape[64];
+    agnes_session_t session = {.string_allocator = allocator};
+    if (session_parse && !agnes_session_init(&session, sizeof(document))) {
+        panic("unable to start session");
+    }
+
+    u64 best = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        u64 start = now_ns();
+        for (int i = 0; i < SMALL_DOCUMENTS; ++i) {
+            agnes_parser_t parser = {
+                .bytes = (u8 const *)document,
+                .file_size = sizeof(document) - 1,
+                .string_allocator = allocator,
+                .tape = tape,
+                .max_tape = 64,
+            };
+            agnes_result_t res = session_parse
+                                     ? agnes_session_parse(&session, &parser)
+                                     : parse_json(&parser);
+            if (res.kind != RES_PARSER_SOME) {
+                panic("parse failed (kind=%d)", res.kind);
+            }
+            if (session_parse) {
+                agnes_session_reset(&session);
+            } else {
+                free_and_invalidate(&global_string_interner);
+            }
+        }
+        u64 elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+
+    if (session_parse) {
+        agnes_session_free(&session);
+    }
+    return (double)best / SMALL_DOCUMENTS;
+}
+
+#define ARENA_STRINGS 2000000
+
+// GiB/s of parse_json (without tokens) on an array of distinct strings, the
+// interner's pools and table allocated with malloc or from global_arena
+static double time_arena(u8 *bytes, bool arena) {
+    size_t size = 0;
+    size += sprintf((char *)bytes + size, "[");
+    for (u32 i = 0; i < ARENA_STRINGS; ++i) {
+        size += sprintf((char *)bytes + size, "\"user-%08x\",",
+                        i * 2654435761u);
+    }
+    size += sprintf((char *)bytes + size, "null]");
+
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    if (arena) {
+        global_arena.huge_pages = true;
+        if (!agnes_arena_init(&global_arena)) {
+            panic("unable to map arena");
+        }
+        allocator = ARENA_ALLOCATOR;
+    }
+
+    u64 best = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        agnes_parser_t parser = {
+            .bytes = bytes,
+            .file_size = size,
+            .string_allocator = allocator,
+        };
+
+        u64 start = now_ns();
+        agnes_result_t res = parse_json(&parser);
+        u64 elapsed = now_ns() - start;
+
+        if (res.kind != RES_PARSER_SOME) {
+            panic("parse_json failed (kind=%d)", res.kind);
+        }
+        best = elapsed < best ? elapsed : best;
+
+        if (arena) {
+            agnes_arena_reset(&global_arena);
+        } else {
+            free_and_invalidate(&global_string_interner);
+        }
+    }
+
+    if (arena) {
+        agnes_arena_free(&global_arena);
+    }
+    return ((double)size / (1024.0 * 1024.0 * 1024.0)) / ((double)best * 1e-9);
+}
+
+/*
+The interner's previous hash, kept here to compare against: stb_ds.h's
+stbds_hash_string (public domain, Sean Barrett), which walks the string a
+byte at a time up to its NUL.
+*/
+#define ROTATE_LEFT(val, n) (((val) << (n)) | ((val) >> (64 - (n))))
+#define ROTATE_RIGHT(val, n) (((val) >> (n)) | ((val) << (64 - (n))))
+
+static size_t stbds_hash_string(char *str, size_t seed) {
+    size_t hash = seed;
+    while (*str)
+        hash = ROTATE_LEFT(hash, 9) + (unsigned char)*str++;
+
+    hash ^= seed;
+    hash = (~hash) + (hash << 18);
+    hash ^= hash ^ ROTATE_RIGHT(hash, 31);
+    hash = hash * 21;
+    hash ^= hash ^ ROTATE_RIGHT(hash, 11);
+    hash += (hash << 6);
+    hash ^= ROTATE_RIGHT(hash, 22);
+    return hash + seed;
+}
+
+#define HASH_STRINGS 4096
+#define HASH_ROUNDS 64
+
+// ns per string for both hashes, on strings of [min_len, max_len] bytes
+static void time_hash(size_t min_len, size_t max_len, u8 *buffer) {
+    static byte_slice strings[HASH_STRINGS];
+    u64 state = 0x9E3779B97F4A7C15ull;
+    u8 *at = buffer;
+    for (size_t i = 0; i < HASH_STRINGS; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        size_t len = min_len + (size_t)(state >> 33) % (max_len - min_len + 1);
+        for (size_t k = 0; k < len; ++k) {
+            at[k] = 'a' + (u8)((state >> (k % 56)) + k) % 26;
+        }
+        at[len] = '\0';
+        strings[i] = (byte_slice){at, len};
+        at += len + 1;
+    }
+
+    // summed so that neither loop is optimised away
+    size_t sink = 0;
+    u64 best_old = UINT64_MAX, best_new = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        u64 start = now_ns();
+        for (int round = 0; round < HASH_ROUNDS; ++round) {
+            for (size_t i = 0; i < HASH_STRINGS; ++i) {
+                sink += stbds_hash_string((char *)strings[i].at, round);
+            }
+        }
+        u64 middle = now_ns();
+        for (int round = 0; round < HASH_ROUNDS; ++round) {
+            for (size_t i = 0; i < HASH_STRINGS; ++i) {
+                sink += hash_bytes(strings[i], round);
+            }
+        }
+        u64 end = now_ns();
+        best_old = middle - start < best_old ? middle - start : best_old;
+        best_new = end - middle < best_new ? end - middle : best_new;
+    }
+
+    double count = (double)HASH_STRINGS * HASH_ROUNDS;
+    printf("hash %3zu-%3zu bytes: stbds_hash_string %6.2f ns, hash_bytes "
+           "%6.2f ns (%zx)\n",
+           min_len, max_len, (double)best_old / count,
+           (double)best_new / count, sink & 0xF);
+}
+
+#define INTERN_KEYS 16384
+#define INTERN_ROUNDS 32
+
+// ns per intern_string() call when nearly every string is already interned,
+// like the keys of a large array of records. With `reserve`, the strings go
+// to one reserved range instead of a growing list of pools.
+static double time_intern(u8 *buffer, size_t reserve) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    static byte_slice keys[INTERN_KEYS];
+    u8 *at = buffer;
+    for (u32 i = 0; i < INTERN_KEYS; ++i) {
+        int len = sprintf((char *)at, "field_%u_%s", i * 2654435761u,
+                          (i & 3) ? "id" : "description");
+        keys[i] = (byte_slice){at, (size_t)len};
+        at += len + 1;
+    }
+
+    u64 best = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        global_string_interner.reserve = reserve;
+        if (!init_global_interner(&global_string_interner, allocator,
+                                  KiB(4))) {
+            panic("unable to initialise interner");
+        }
+        for (u32 i = 0; i < INTERN_KEYS; ++i) {
+            intern_string(&global_string_interner, keys[i]);
+        }
+
+        u64 start = now_ns();
+        for (int round = 0; round < INTERN_ROUNDS; ++round) {
+            for (u32 i = 0; i < INTERN_KEYS; ++i) {
+                intern_string(&global_string_interner, keys[i]);
+            }
+        }
+        u64 elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+
+        free_and_invalidate(&global_string_interner);
+    }
+
+    return (double)best / ((double)INTERN_KEYS * INTERN_ROUNDS);
+}
+
+#define SCHEMA_KEYS 300
+#define SCHEMA_ROUNDS 4096
+
+// ns per intern_string() call on the field names of a schema, with or
+// without registering them as known keys
+static double time_known(u8 *buffer, bool known) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    static byte_slice keys[SCHEMA_KEYS];
+    static char const *names[SCHEMA_KEYS];
+    u8 *at = buffer;
+    for (u32 i = 0; i < SCHEMA_KEYS; ++i) {
+        int len = sprintf((char *)at, "%s_%u",
+                          (i & 1) ? "created_at" : "customer", i);
+        keys[i] = (byte_slice){at, (size_t)len};
+        names[i] = (char const *)at;
+        at += len + 1;
+    }
+
+    u64 best = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        interner_t interner = {.known_keys = known ? names : NULL,
+                               .known_key_count = known ? SCHEMA_KEYS : 0};
+        if (!init_global_interner(&interner, allocator, KiB(64))) {
+            panic("unable to initialise interner");
+        }
+        for (u32 i = 0; i < SCHEMA_KEYS; ++i) {
+            intern_string(&interner, keys[i]);
+        }
+
+        u64 start = now_ns();
+        for (int round = 0; round < SCHEMA_ROUNDS; ++round) {
+            for (u32 i = 0; i < SCHEMA_KEYS; ++i) {
+                intern_string(&interner, keys[i]);
+            }
+        }
+        u64 elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+
+        free_and_invalidate(&interner);
+    }
+
+    return (double)best / ((double)SCHEMA_KEYS * SCHEMA_ROUNDS);
+}
+
+#define SHARED_KEYS 65536
+#define SHARED_ROUNDS 8
+#define SHARED_SHARDS 64
+
+typedef struct intern_worker {
+    interner_t *interner;
+    byte_slice const *keys;
+    u32 first; // threads start at different keys, not in lockstep
+} intern_worker_t;
+
+static AG_THREAD_PROC(intern_worker_proc) {
+    intern_worker_t *worker = (intern_worker_t *)arg;
+    for (int round = 0; round < SHARED_ROUNDS; ++round) {
+        for (u32 i = 0; i < SHARED_KEYS; ++i) {
+            intern_string(worker->interner,
+                          worker->keys[(worker->first + i) % SHARED_KEYS]);
+        }
+    }
+    AG_THREAD_RETURN;
+}
+
+// million intern_string() calls per second over `threads` threads that all
+// intern the same keys: into one shared interner, or each into its own.
+// `stored` is set to the number of strings kept in the end.
+static double time_shared_intern(u8 *buffer, size_t threads, bool shared,
+                                 size_t *stored) {
+    allocator_t allocator = {.alloc = stupid_alloc, .free = stupid_free};
+    static byte_slice keys[SHARED_KEYS];
+    u8 *at = buffer;
+    for (u32 i = 0; i < SHARED_KEYS; ++i) {
+        int len = sprintf((char *)at, "key_%u", i * 2654435761u);
+        keys[i] = (byte_slice){at, (size_t)len};
+        at += len + 1;
+    }
+
+    interner_t *interners;
+    intern_worker_t *workers;
+    ag_thread_t *handles;
+    if (!stupid_alloc(threads * sizeof(interner_t), (u8 **)&interners) ||
+        !stupid_alloc(threads * sizeof(intern_worker_t), (u8 **)&workers) ||
+        !stupid_alloc(threads * sizeof(ag_thread_t), (u8 **)&handles)) {
+        panic("unable to allocate workers");
+    }
+
+    u64 best = UINT64_MAX;
+    for (int run = 0; run < RUNS; ++run) {
+        size_t count = shared ? 1 : threads;
+        for (size_t i = 0; i < count; ++i) {
+            interners[i] = (interner_t){
+                .shard_count = shared ? SHARED_SHARDS : 0};
+            if (!init_global_interner(&interners[i], allocator, KiB(64))) {
+                panic("unable to initialise interner");
+            }
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers[i] = (intern_worker_t){
+                .interner = &interners[shared ? 0 : i],
+                .keys = keys,
+                .first = (u32)(i * SHARED_KEYS / threads)};
+        }
+
+        u64 start = now_ns();
+        for (size_t i = 0; i < threads; ++i) {
+            if (!ag_thread_start(&handles[i], intern_worker_proc,
+                                 &workers[i])) {
+                panic("unable to start thread");
+            }
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            ag_thread_join(handles[i]);
+        }
+        u64 elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+
+        *stored = 0;
+        for (size_t i = 0; i < count; ++i) {
+            interner_t *interner = &interners[i];
+            for (size_t k = 0; shared && k < interner->shard_count; ++k) {
+                *stored += interner->shards[k].interner.string_count;
+            }
+            *stored += interner->string_count * !shared;
+            free_and_invalidate(interner);
+        }
+    }
+
+    stupid_free((u8 *)interners);
+    stupid_free((u8 *)workers);
+    stupid_free((u8 *)handles);
+    return (double)threads * SHARED_KEYS * SHARED_ROUNDS * 1e3 / (double)best;
+}
+
+// arguments: [1] (optional): json file, otherwise a document is generated
+int main(int argc, char const *argv[]) {
+    size_t max_file_size = MiB(256);
+
+    u8 *bytes;
+    if (!stupid_alloc(max_file_size, &bytes)) {
+        panic("unable to allocate input buffer");
+    }
+
+    size_t size;
+    if (argc > 1) {
+        FILE *handle = fopen(argv[1], "rb");
+        if (handle == NULL) {
+            panic("unable to open %s", argv[1]);
+        }
+        size = fread(bytes, 1, max_file_size, handle);
+        fclose(handle);
+    } else {
+        size = generate_document(bytes, MiB(64));
+    }
+
+    size_t max_tokens = size + 1;
+    packed_token_t *tokens;
+    if (!stupid_alloc(max_tokens * sizeof(packed_token_t), (u8 **)&tokens)) {
+        panic("unable to allocate token buffer");
+    }
+
+    size_t scalar_tokens, block_tokens;
+    double scalar = time_tokenize(tokenize_scalar, bytes, size, tokens,
+                                  max_tokens, &scalar_tokens);
+    double block = time_tokenize(tokenize, bytes, size, tokens, max_tokens,
+                                 &block_tokens);
+
+    if (scalar_tokens != block_tokens) {
+        panic("token count mismatch: %zu vs %zu", scalar_tokens, block_tokens);
+    }
+
+    printf("input: %.1f MiB, %zu tokens (best of %d runs)\n",
+           (double)size / (1024.0 * 1024.0), block_tokens, RUNS);
+    printf("tokenize_scalar: %6.3f GiB/s\n", scalar);
+    printf("tokenize:        %6.3f GiB/s\n", block);
+
+    size_t cores = ag_cpu_count();
+    for (parallel_threads = 2; parallel_threads <= cores;
+         parallel_threads *= 2) {
+        size_t parallel_tokens;
+        double parallel =
+            time_tokenize(tokenize_threads, bytes, size, tokens, max_tokens,
+                          &parallel_tokens);
+        if (parallel_tokens != block_tokens) {
+            panic("token count mismatch: %zu vs %zu", parallel_tokens,
+                  block_tokens);
+        }
+        printf("tokenize_parallel, %3zu threads: %6.3f GiB/s\n",
+               parallel_threads, parallel);
+    }
+
+    size = generate_ndjson(bytes, MiB(64));
+    size_t records = count_records(bytes, size);
+    agnes_result_t *results;
+    if (!stupid_alloc(records * sizeof(agnes_result_t), (u8 **)&results)) {
+        panic("unable to allocate results");
+    }
+
+    printf("ndjson: %.1f MiB, %zu records, %zu cores\n",
+           (double)size / (1024.0 * 1024.0), records, cores);
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        printf("parse_ndjson, %3zu threads: %6.3f GiB/s\n", threads,
+               time_ndjson(bytes, size, threads, results, records));
+    }
+
+    // no more than a value per byte, and two words per value
+    size = generate_coordinates(bytes, MiB(16));
+    size_t max_tape = 2 * size + 2;
+    u64 *tape;
+    if (size + 1 > max_tokens ||
+        !stupid_alloc(max_tape * sizeof(u64), (u8 **)&tape)) {
+        panic("unable to allocate tape");
+    }
+
+    printf("coordinates: %.1f MiB\n", (double)size / (1024.0 * 1024.0));
+    printf("parse_json, raw numbers:    %6.3f GiB/s\n",
+           time_tape(bytes, size, tokens, max_tokens, tape, max_tape, true));
+    printf("parse_json, native numbers: %6.3f GiB/s\n",
+           time_tape(bytes, size, tokens, max_tokens, tape, max_tape, false));
+
+    printf("small documents, parse_json:          %7.1f ns\n",
+           time_small(false));
+    printf("small documents, agnes_session_parse: %7.1f ns\n",
+           time_small(true));
+
+    printf("%d distinct strings, parse_json, malloc:       %6.3f GiB/s\n",
+           ARENA_STRINGS, time_arena(bytes, false));
+    printf("%d distinct strings, parse_json, global_arena: %6.3f GiB/s\n",
+           ARENA_STRINGS, time_arena(bytes, true));
+
+    static size_t const hash_buckets[][2] = {
+        {1, 4}, {5, 8}, {9, 16}, {17, 32}, {33, 64}, {65, 128}, {129, 256},
+    };
+    for (size_t i = 0; i < sizeof(hash_buckets) / sizeof(*hash_buckets); ++i) {
+        time_hash(hash_buckets[i][0], hash_buckets[i][1], bytes);
+    }
+
+    printf("intern_string, %d keys seen before: %6.2f ns\n", INTERN_KEYS,
+           time_intern(bytes, 0));
+    printf("intern_string, same, reserved range: %6.2f ns\n",
+           time_intern(bytes, GiB(4ull)));
+
+    printf("intern_string, %d schema keys, in the table:  %6.2f ns\n",
+           SCHEMA_KEYS, time_known(bytes, false));
+    printf("intern_string, %d schema keys, known keys:    %6.2f ns\n",
+           SCHEMA_KEYS, time_known(bytes, true));
+
+    printf("interning %d keys on every thread, %d shards (M calls/s)\n",
+           SHARED_KEYS, SHARED_SHARDS);
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        size_t shared_strings, own_strings;
+        double shared = time_shared_intern(bytes, threads, true,
+                                           &shared_strings);
+        double own = time_shared_intern(bytes, threads, false, &own_strings);
+        printf("%2zu threads: shared %7.2f (%7zu strings), one per thread "
+               "%7.2f (%7zu strings)\n",
+               threads, shared, shared_strings, own, own_strings);
+    }
+
+    return EXIT_SUCCESS;
+}
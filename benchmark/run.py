@@ -0,0 +1,63 @@
+#!/bin/python
+
+import os
+import subprocess
+import argparse
+import shutil
+
+argparser = argparse.ArgumentParser()
+
+argparser.add_argument('--build-only', action=argparse.BooleanOptionalAction, default=False)
+argparser.add_argument('--cleanup', action=argparse.BooleanOptionalAction, default=False)
+argparser.add_argument('--input', type=str, default=None)
+argparser.add_argument('--avx2', action=argparse.BooleanOptionalAction, default=True)
+
+args = argparser.parse_args()
+
+# change this, if you are on Windows:
+VISUAL_STUDIO_AT = R"C:\Program Files\Microsoft Visual Studio\18\Community\VC\Auxiliary\Build\vcvarsall.bat"
+
+exec = "bench"
+if os.name == "nt":
+    exec = exec + ".exe"
+else:
+    exec = exec + ".out"
+
+headers = ["common.h", "parser.h", "interner.h", "arena.h"] 
+
+if not os.path.exists("build"):
+    os.mkdir("build")
+
+source_file_abs = os.path.abspath("bench.c")
+flags = ["-O2"] + (["-mavx2", "-mpopcnt", "-mbmi"] if args.avx2 else [])
+run_args = [os.path.abspath(args.input)] if args.input else []
+
+if os.name == "nt":
+    for header_file in headers:
+        subprocess.run(["xcopy", "/f", "/y", ("..\\" + header_file), "."], shell=True)
+
+    os.chdir("build")
+    subprocess.run([VISUAL_STUDIO_AT, "x64", "&&", "clang", source_file_abs] + flags + ["-o", exec], shell=True)
+
+    if not args.build_only:
+        subprocess.run([exec] + run_args)
+
+    os.chdir("..")
+
+    if args.cleanup:
+        for header_file in headers:
+            subprocess.run(["del", header_file], shell=True)
+else: 
+    for header_file in headers:
+        shutil.copyfile("../" + header_file, header_file)
+    
+    os.chdir("build")
+    subprocess.run(["clang", source_file_abs] + flags + ["-o", exec]) 
+    if not args.build_only:    
+        subprocess.run(["./" + exec] + run_args)
+
+    os.chdir("..")
+
+    if args.cleanup:
+        for header_file in headers:
+            subprocess.run(["rm", header_file], shell=True)
@@ -1,5 +1,10 @@
 #if !defined(AG_COMMON_H)
 #define AG_COMMON_H
+// MAP_ANONYMOUS, MADV_* and CLOCK_MONOTONIC are hidden by strict modes such
+// as -std=c11 without it, so include this before any system header
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -8,6 +13,11 @@
 
 #define DEBUG_LOG 1
 
+// 1 to fill agnes_stats_t where one is passed, 0 compiles the counting out
+#if !defined(AG_STATS)
+#define AG_STATS 0
+#endif
+
 #define KiB(n) (n * 1024u)
 #define MiB(n) (KiB(n) * 1024u)
 #define GiB(n) (MiB(n) * 1024u)
@@ -16,17 +26,315 @@ typedef uint8_t u8;
 typedef uint16_t u16;
 typedef uint32_t u32;
 typedef uint64_t u64;
+typedef int64_t i64;
+
+// SIMD kernels are picked at compile time. Define AG_NO_SIMD to force the
+// portable code paths (useful for comparing results and throughput).
+#if !defined(AG_NO_SIMD) && defined(__AVX2__)
+#define AG_AVX2 1
+#define AG_SSE2 1
+#include <immintrin.h>
+#elif !defined(AG_NO_SIMD) &&                                                  \
+    (defined(__SSE2__) || defined(_M_X64) ||                                   \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define AG_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline u32 ag_ctz64(u64 x) {
+    unsigned long at;
+    _BitScanForward64(&at, x);
+    return (u32)at;
+}
+static inline u32 ag_popcount64(u64 x) { return (u32)__popcnt64(x); }
+static inline u32 ag_clz64(u64 x) {
+    unsigned long at;
+    _BitScanReverse64(&at, x);
+    return 63 - (u32)at;
+}
+// the low word of a * b, the high one goes to *high
+static inline u64 ag_mul128(u64 a, u64 b, u64 *high) {
+    *high = __umulh(a, b);
+    return a * b;
+}
+#else
+// undefined for x == 0
+static inline u32 ag_ctz64(u64 x) { return (u32)__builtin_ctzll(x); }
+static inline u32 ag_popcount64(u64 x) { return (u32)__builtin_popcountll(x); }
+// undefined for x == 0
+static inline u32 ag_clz64(u64 x) { return (u32)__builtin_clzll(x); }
+// the low word of a * b, the high one goes to *high
+static inline u64 ag_mul128(u64 a, u64 b, u64 *high) {
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (u64)(product >> 64);
+    return (u64)product;
+}
+#endif
+
+// minimal threads, for the batch entry points and the shared interner
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+typedef HANDLE ag_thread_t;
+#define AG_THREAD_PROC(name) DWORD WINAPI name(LPVOID arg)
+#define AG_THREAD_RETURN return 0
+
+static inline bool ag_thread_start(ag_thread_t *thread,
+                                   LPTHREAD_START_ROUTINE proc, void *arg) {
+    *thread = CreateThread(NULL, 0, proc, arg, 0, NULL);
+    return *thread != NULL;
+}
+static inline void ag_thread_join(ag_thread_t thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+static inline size_t ag_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+static inline u64 ag_now_ns(void) {
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (u64)((double)counter.QuadPart * 1e9 / (double)freq.QuadPart);
+}
+
+typedef SRWLOCK ag_mutex_t;
+static inline void ag_mutex_init(ag_mutex_t *mutex) {
+    InitializeSRWLock(mutex);
+}
+static inline void ag_mutex_lock(ag_mutex_t *mutex) {
+    AcquireSRWLockExclusive(mutex);
+}
+static inline void ag_mutex_unlock(ag_mutex_t *mutex) {
+    ReleaseSRWLockExclusive(mutex);
+}
+static inline void ag_mutex_destroy(ag_mutex_t *mutex) { (void)mutex; }
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+typedef pthread_t ag_thread_t;
+#define AG_THREAD_PROC(name) void *name(void *arg)
+#define AG_THREAD_RETURN return NULL
+
+static inline bool ag_thread_start(ag_thread_t *thread, void *(*proc)(void *),
+                                   void *arg) {
+    return pthread_create(thread, NULL, proc, arg) == 0;
+}
+static inline void ag_thread_join(ag_thread_t thread) {
+    pthread_join(thread, NULL);
+}
+static inline size_t ag_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (size_t)count;
+}
+static inline u64 ag_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000u + (u64)ts.tv_nsec;
+}
+
+typedef pthread_mutex_t ag_mutex_t;
+static inline void ag_mutex_init(ag_mutex_t *mutex) {
+    pthread_mutex_init(mutex, NULL);
+}
+static inline void ag_mutex_lock(ag_mutex_t *mutex) {
+    pthread_mutex_lock(mutex);
+}
+static inline void ag_mutex_unlock(ag_mutex_t *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+static inline void ag_mutex_destroy(ag_mutex_t *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+#endif
+
+// virtual memory: reserve a range of addresses without backing it, then
+// commit pages of it as they are needed
+#if defined(_WIN32)
+static inline u8 *ag_reserve(size_t size) {
+    return (u8 *)VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+static inline bool ag_commit(u8 *at, size_t size) {
+    return VirtualAlloc(at, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+static inline void ag_release(u8 *at, size_t size) {
+    (void)size;
+    VirtualFree(at, 0, MEM_RELEASE);
+}
+// `size` bytes of memory, on large pages if `huge` and the process may use
+// them (SeLockMemoryPrivilege). Freed with ag_release.
+static inline u8 *ag_map(size_t size, bool huge) {
+    if (huge) {
+        void *at = VirtualAlloc(NULL, size,
+                                MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                PAGE_READWRITE);
+        if (at != NULL) {
+            return (u8 *)at;
+        }
+    }
+    return (u8 *)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT,
+                              PAGE_READWRITE);
+}
+// the file at `path`, mapped read-only, NULL if it cannot be
+static inline u8 const *ag_map_file(char const *path, size_t *size) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return NULL;
+    }
+    *size = (size_t)file_size.QuadPart;
+    if (*size == 0) {
+        // an empty mapping is an error, an empty input is not
+        CloseHandle(file);
+        return (u8 const *)"";
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return NULL;
+    }
+    // the view keeps the mapping alive
+    void *at = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    return (u8 const *)at;
+}
+static inline void ag_unmap_file(u8 const *at, size_t size) {
+    if (size > 0) {
+        UnmapViewOfFile(at);
+    }
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+static inline u8 *ag_reserve(size_t size) {
+    void *at = mmap(NULL, size, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return at == MAP_FAILED ? NULL : (u8 *)at;
+}
+static inline bool ag_commit(u8 *at, size_t size) {
+    return mprotect(at, size, PROT_READ | PROT_WRITE) == 0;
+}
+static inline void ag_release(u8 *at, size_t size) { munmap(at, size); }
+// `size` bytes of memory, on huge pages if `huge` and some are reserved
+// (MAP_HUGETLB), else on transparent huge pages where the kernel has them.
+// Freed with ag_release.
+static inline u8 *ag_map(size_t size, bool huge) {
+#if defined(MAP_HUGETLB)
+    if (huge) {
+        void *at = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (at != MAP_FAILED) {
+            return (u8 *)at;
+        }
+    }
+#endif
+    void *at = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (at == MAP_FAILED) {
+        return NULL;
+    }
+#if defined(MADV_HUGEPAGE)
+    if (huge) {
+        madvise(at, size, MADV_HUGEPAGE);
+    }
+#endif
+    return (u8 *)at;
+}
+// the file at `path`, mapped read-only, NULL if it cannot be. Its pages are
+// read in up front (MAP_POPULATE) where that is supported, and in order.
+static inline u8 const *ag_map_file(char const *path, size_t *size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)info.st_size;
+    if (*size == 0) {
+        // an empty mapping is an error, an empty input is not
+        close(fd);
+        return (u8 const *)"";
+    }
+    int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+    flags |= MAP_POPULATE;
+#endif
+    void *at = mmap(NULL, *size, PROT_READ, flags, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (at == MAP_FAILED) {
+        return NULL;
+    }
+    madvise(at, *size, MADV_SEQUENTIAL);
+    return (u8 const *)at;
+}
+static inline void ag_unmap_file(u8 const *at, size_t size) {
+    if (size > 0) {
+        munmap((void *)at, size);
+    }
+}
+#endif
+
+// huge page size on x86-64 and most arm64 kernels
+#define AG_HUGE_PAGE MiB(2)
 
 typedef struct byte_slice {
     u8 *at;
     size_t len;
 } byte_slice;
 
+// a dense id for an interned string, 0 for none (see interner.h)
+typedef u32 agnes_string_t;
+
 typedef struct allocator {
     bool (*alloc)(size_t, u8 **out);
     void (*free)(u8 *);
 } allocator_t;
 
+// lookups in the interner's table by the number of groups they probed:
+// 1, 2, ... and the last bucket for AG_PROBE_BUCKETS or more
+#define AG_PROBE_BUCKETS 8
+
+// what a parse did, filled only when compiled with AG_STATS
+typedef struct agnes_stats {
+    // interning: every string passed in, and those stored because they
+    // were new. Deduplication saved bytes - unique_bytes.
+    size_t strings;
+    size_t bytes;
+    size_t unique;
+    size_t unique_bytes;
+    size_t probes[AG_PROBE_BUCKETS];
+    size_t rebuilds; // times the table grew
+
+    // the interner's pools when the parse ended
+    size_t pools;
+    size_t pool_bytes; // allocated (or committed, in a reservation)
+    size_t pool_used;  // holding strings, with their ids and terminators
+
+    size_t tokens; // 0 without a token buffer
+
+    // Time spent in each phase, interning is not counted in the others.
+    // Without a token buffer, tokenizing and parsing are one pass, counted
+    // as parse_ns.
+    u64 tokenize_ns;
+    u64 intern_ns;
+    u64 parse_ns;
+} agnes_stats_t;
+
 #define MAX_FORMATTED_STRING_SIZE 512
 static char formatted_string[MAX_FORMATTED_STRING_SIZE];
 
@@ -67,4 +375,11 @@ static char formatted_string[MAX_FORMATTED_STRING_SIZE];
 #define dbg(...) __nop(__VA_ARGS__)
 #endif
 
+// STAT(code) is there only with AG_STATS
+#if AG_STATS
+#define STAT(...) __VA_ARGS__
+#else
+#define STAT(...)
+#endif
+
 #endif
\ No newline at end of file
@@ -34,14 +34,17 @@ int main(int argc, char const *argv[]) {
     parser.bytes = reserved_memory_pool;
     parser.file_size = sizeof(json_data);
     parser.filename = filename;
-    parser.max_tokens = max_file_size / sizeof(token_t);
+    parser.max_tokens = max_file_size / sizeof(packed_token_t);
 
-    parser.tokens = (token_t *)(reserved_memory_pool + max_file_size);
-    parser.line_info = (size_t *)(reserved_memory_pool + 2 * max_file_size);
+    parser.tokens = (packed_token_t *)(reserved_memory_pool + max_file_size);
 
     parser.string_allocator =
         (allocator_t){.alloc = stupid_alloc, .free = stupid_free};
 
+    u64 tape[64];
+    parser.tape = tape;
+    parser.max_tape = 64;
+
     agnes_result_t result = parse_json(&parser);
 
     if (result.kind == RES_PARSER_ERROR || result.kind == RES_LEXER_ERROR ||
@@ -51,5 +54,14 @@ int main(int argc, char const *argv[]) {
 
     dbg("got: %s", format_jvalue(result.jvalue));
 
+    tape_iter_t root = tape_root(&parser);
+    for (tape_iter_t it = tape_child(root); !tape_at_end(it);
+         it = tape_next(it)) {
+        byte_slice key = tape_string(it);
+        it = tape_next(it);
+        dbg("member: %.*s (%s)", (int)key.len, key.at,
+            format_jvalue(tape_kind(it)));
+    }
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
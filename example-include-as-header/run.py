@@ -21,7 +21,7 @@ if os.name == "nt":
 else:
     exec = exec + ".out"
 
-headers = ["common.h", "parser.h", "interner.h"] 
+headers = ["common.h", "parser.h", "interner.h", "arena.h"] 
 
 if not os.path.exists("build"):
     os.mkdir("build")
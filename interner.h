@@ -14,8 +14,21 @@ and pointers to these allocations remain valid.
 it is assumed that any pointer within the address space of any of the pools, is
 one that represents an exact string previously allocated by the interner, and
 not any range of bytes within such a pool.
+
+3) Each string is numbered in the order it was first interned, starting at 1.
+The number is stored in the 4 bytes before the string, so it can be read
+back from the string, and `strings` maps it back to the string.
+
+4) A shared interner (shard_count > 1) is only a set of shards, each a whole
+interner of its own behind a lock. A string always goes to the shard picked
+by the top bits of its hash, so it is stored once however many threads
+intern it, and threads interning different strings rarely wait for each
+other. A shard numbers its strings itself, the shard's index is in the low
+bits of the id.
 */
 
+typedef struct interner_shard interner_shard_t;
+
 typedef struct string_set_entry {
     size_t hash;
     byte_slice rawptr;
@@ -31,12 +44,29 @@ typedef enum ctrl_byte {
 typedef struct string_interner {
     struct {
         set_entry_t *hashset;
-        u8 *ctrl_bytes;
+        u8 *ctrl_bytes; // the same allocation as `hashset`
 
         size_t hashset_cap;
-        size_t hashset_occ;
+        size_t hashset_occ; // in both tables while growing
+
+        // while growing: the previous table, whose entries move to the new
+        // one a few at a time (see migrate_entries)
+        set_entry_t *old_hashset;
+        u8 *old_ctrl_bytes;
+        size_t old_cap;
+        size_t migrate_at; // old slots below this one are moved
+
+        // the table to grow into, its control bytes cleared ahead of time
+        // (see prepare_table)
+        set_entry_t *next_hashset;
+        u8 *next_ctrl_bytes;
+        size_t next_cleared;
     };
 
+    // optional: fraction of the table filled before it grows, 0 for
+    // INTERNER_MAX_LOAD. Read by init_global_interner.
+    double max_load;
+
     u8 *current_pool;
     size_t next_string;
     size_t current_pool_size;
@@ -46,177 +76,440 @@ typedef struct string_interner {
     size_t pool_at;
     size_t max_pools;
 
+    // optional: > 0 to reserve this many bytes of address space for all
+    // strings up front instead of allocating pools. Pages are committed as
+    // the strings grow, and `pools` is not used. Read by init_global_interner.
+    size_t reserve;
+    u8 *reserved; // set while the interner uses a reservation
+
+    byte_slice *strings; // by id, strings[0] is unused
+    size_t string_count;
+    size_t strings_cap;
+
+    // optional: > 1 to share the interner between threads, split into this
+    // many shards (rounded up to a power of two, at most MAX_SHARDS).
+    // Read by init_global_interner.
+    size_t shard_count;
+    interner_shard_t *shards; // set while the interner is shared
+
+    // in a shard: ids are the shard's own number << id_shift | id_tag
+    u32 id_shift;
+    u32 id_tag;
+
+    // optional: strings to intern before any other, in this order, so that
+    // they get the first ids. They are looked up with a perfect hash built
+    // for them instead of in the table. Read by init_global_interner.
+    char const *const *known_keys;
+    size_t known_key_count;
+    struct {
+        set_entry_t *known; // known_cap slots, .rawptr.at is NULL if empty
+        u32 *known_disp;    // per bucket: where its keys go (see known_slot)
+        size_t known_cap;
+        size_t known_buckets;
+        u8 *known_strings; // the keys, stored the way pools store strings
+        size_t known_size;
+    };
+    size_t permanent; // strings[1..permanent] survive reset_interner
+
+    agnes_stats_t *stats; // optional: counted into with AG_STATS
+
     allocator_t allocator;
 
     size_t seed;
 } interner_t;
+#endif
 
-#if defined(AG_INTERNER_IMPLEMENT)
+#if defined(AG_INTERNER_IMPLEMENT) && !defined(AG_INTERNER_IMPLEMENTED)
+#define AG_INTERNER_IMPLEMENTED
+
+struct interner_shard {
+    ag_mutex_t lock;
+    interner_t interner;
+};
 
 #define POOL_ARRAY_SIZE 10u
+#define STRING_ARRAY_SIZE 1024u
 
 #define HASH_SET_ENTRIES 8192
+#define INTERNER_MAX_LOAD 0.75
+#define INTERNER_GROWTH 4
+// old slots looked at per insert while growing
+#define MIGRATE_SLOTS 64
+// control bytes of the next table cleared per insert, past half the load
+#define PREPARE_BYTES KiB(4)
+// a reservation is committed in multiples of this (Windows' granularity)
+#define COMMIT_GRANULE KiB(64)
+#define ROUND_UP(n, to) (((n) + (to) - 1) / (to) * (to))
 
 size_t H1(size_t hash) { return hash >> 7; }
 ctrl_byte_t H2(size_t hash) { return hash & 0x7F; }
 
+/*
+The table is probed a group of GROUP_WIDTH control bytes at a time: one
+compare finds every slot in the group whose H2 matches, another every empty
+slot. The capacity is a power of two (and a multiple of GROUP_WIDTH), groups
+are visited in triangular steps, which reaches each of them once.
+Nothing is ever removed, so the first group with an empty slot ends a probe.
+*/
+#define GROUP_WIDTH 16
+
+typedef u32 group_mask_t; // bit i for slot i of the group
+
+#if defined(AG_SSE2)
+static inline group_mask_t group_match(u8 const *ctrl, u8 h2) {
+    __m128i group = _mm_loadu_si128((__m128i const *)ctrl);
+    return (group_mask_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+static inline group_mask_t group_match_empty(u8 const *ctrl) {
+    return group_match(ctrl, kEmpty);
+}
+#else
+#define SWAR_LSB 0x0101010101010101ull
+#define SWAR_MSB 0x8080808080808080ull
+
+// the top bit of byte i (little-endian) to bit i
+static inline group_mask_t swar_gather(u64 bits) {
+    return (group_mask_t)(((bits >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+static inline u64 swar_load(u8 const *ctrl) {
+    u64 word;
+    memcpy(&word, ctrl, sizeof(word));
+    return word;
+}
+
+// Bytes equal to h2. A borrow can flag the byte above a match as well, the
+// caller compares hashes anyway.
+static inline group_mask_t swar_match(u64 word, u8 h2) {
+    u64 x = word ^ (SWAR_LSB * h2);
+    return swar_gather((x - SWAR_LSB) & ~x & SWAR_MSB);
+}
+
+static inline group_mask_t group_match(u8 const *ctrl, u8 h2) {
+    return swar_match(swar_load(ctrl), h2) |
+           swar_match(swar_load(ctrl + 8), h2) << 8;
+}
+
+// kEmpty is the only control byte with the top bit set and bit 1 clear
+static inline group_mask_t swar_match_empty(u64 word) {
+    return swar_gather(word & ~(word << 6) & SWAR_MSB);
+}
+
+static inline group_mask_t group_match_empty(u8 const *ctrl) {
+    return swar_match_empty(swar_load(ctrl)) |
+           swar_match_empty(swar_load(ctrl + 8)) << 8;
+}
+#endif
+
+// wraps group indices, the first group probed for a hash is H1 & GROUP_MASK
+#define GROUP_MASK(interner) ((interner)->hashset_cap / GROUP_WIDTH - 1)
+
 #include <time.h>
 
 /**********************
-stb_ds.h - v0.67 - public domain data structures - Sean Barrett 2019
-https://github.com/nothings/stb
-https://nothings.org/stb_ds
+wyhash (final version 4) - public domain - Wang Yi
+https://github.com/wangyi-fudan/wyhash
 
-Credit to Sean Barrett for hashing routine.
+Reads 8 or 16 bytes at a time and never looks past `bytes.len`, so strings
+need neither a terminator nor a copy before they are hashed.
 */
-#define STBDS_SIZE_T_BITS ((sizeof(size_t)) * 8)
-
-#define STBDS_ROTATE_LEFT(val, n)                                              \
-    (((val) << (n)) | ((val) >> (STBDS_SIZE_T_BITS - (n))))
-#define STBDS_ROTATE_RIGHT(val, n)                                             \
-    (((val) >> (n)) | ((val) << (STBDS_SIZE_T_BITS - (n))))
-
-// assumes strings are null-terminated
-static size_t stbds_hash_string(char *str, size_t seed) {
-    size_t hash = seed;
-    while (*str)
-        hash = STBDS_ROTATE_LEFT(hash, 9) + (unsigned char)*str++;
-
-    // Thomas Wang 64-to-32 bit mix function, hopefully also works in 32 bits
-    hash ^= seed;
-    hash = (~hash) + (hash << 18);
-    hash ^= hash ^ STBDS_ROTATE_RIGHT(hash, 31);
-    hash = hash * 21;
-    hash ^= hash ^ STBDS_ROTATE_RIGHT(hash, 11);
-    hash += (hash << 6);
-    hash ^= STBDS_ROTATE_RIGHT(hash, 22);
-    return hash + seed;
+static u64 const wyhash_secret[4] = {
+    0x2d358dccaa6c78a5ull,
+    0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull,
+};
+
+static inline u64 wymix(u64 a, u64 b) {
+    u64 high;
+    u64 low = ag_mul128(a, b, &high);
+    return low ^ high;
 }
 
-/*
-**********************/
+static inline u64 wyread8(u8 const *p) {
+    u64 v;
+    memcpy(&v, p, 8);
+    return v;
+}
 
-static bool bytes_strict_eq(byte_slice left, byte_slice right) {
-    if (left.len != right.len) {
-        return false;
+static inline u64 wyread4(u8 const *p) {
+    u32 v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static size_t hash_bytes(byte_slice bytes, size_t seed) {
+    u8 const *p = bytes.at;
+    size_t len = bytes.len;
+    u64 const *secret = wyhash_secret;
+    u64 a, b;
+
+    seed ^= wymix(seed ^ secret[0], secret[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            // two overlapping 4-byte reads from either end
+            a = (wyread4(p) << 32) | wyread4(p + ((len >> 3) << 2));
+            b = (wyread4(p + len - 4) << 32) |
+                wyread4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((u64)p[0] << 16) | ((u64)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            u64 see1 = seed, see2 = seed;
+            do {
+                seed = wymix(wyread8(p) ^ secret[1], wyread8(p + 8) ^ seed);
+                see1 = wymix(wyread8(p + 16) ^ secret[2],
+                             wyread8(p + 24) ^ see1);
+                see2 = wymix(wyread8(p + 32) ^ secret[3],
+                             wyread8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(wyread8(p) ^ secret[1], wyread8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // the last 16 bytes, overlapping what came before
+        a = wyread8(p + i - 16);
+        b = wyread8(p + i - 8);
     }
 
-    // legal access always (since I append null-terminator to all strings)
-    if (left.at[0] != right.at[0]) {
+    a ^= secret[1];
+    b ^= seed;
+    a = ag_mul128(a, b, &b);
+    return wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/*
+**********************/
+
+// `stored` is an interned string, its .len counts the NUL terminator
+static bool stored_eq(byte_slice stored, byte_slice source) {
+    if (stored.len != source.len + 1) {
         return false;
     }
-    return memcmp(left.at, right.at, left.len - 1) == 0;
+    return memcmp(stored.at, source.at, source.len) == 0;
 }
 
-static void rebuild_table(interner_t *interner) {
-    size_t old_cap = interner->hashset_cap;
-    set_entry_t *old_hashset = interner->hashset;
-    u8 *old_ctrl_bytes = interner->ctrl_bytes;
-
-    size_t new_cap = interner->hashset_cap = interner->hashset_cap * 4;
+// puts `entry` in the first empty slot of its probe sequence
+static void insert_entry(u8 *ctrl_bytes, set_entry_t *hashset,
+                         size_t group_mask, set_entry_t entry) {
+    size_t group = H1(entry.hash) & group_mask;
+    group_mask_t empty;
+    for (size_t step = 1;
+         (empty = group_match_empty(ctrl_bytes + group * GROUP_WIDTH)) == 0;
+         ++step) {
+        group = (group + step) & group_mask;
+    }
 
-    u8 *new_ctrl_bytes;
-    set_entry_t *new_hashset;
+    size_t pos = group * GROUP_WIDTH + ag_ctz64(empty);
+    ctrl_bytes[pos] = H2(entry.hash);
+    hashset[pos] = entry;
+}
 
-    if (!interner->allocator.alloc(interner->hashset_cap * sizeof(set_entry_t),
-                                   &new_hashset)) {
-        panic("ran out of space while allocating string hashset");
+// one allocation: `cap` control bytes (not cleared), then the entries
+static bool alloc_table(interner_t *interner, size_t cap, u8 **ctrl_bytes,
+                        set_entry_t **hashset) {
+    if (!interner->allocator.alloc(cap * (sizeof(u8) + sizeof(set_entry_t)),
+                                   ctrl_bytes)) {
+        return false;
     }
+    *hashset = (set_entry_t *)(*ctrl_bytes + cap * sizeof(u8));
+    return true;
+}
 
-    if (!interner->allocator.alloc(interner->hashset_cap * sizeof(u8),
-                                   &new_ctrl_bytes)) {
-        panic("ran out of space while allocating string hashset");
+// Allocates the next table and clears up to `bytes` more of its control
+// bytes. Clearing them all at once would touch every page of a large table
+// in one insert.
+static void prepare_table(interner_t *interner, size_t bytes) {
+    size_t next_cap = interner->hashset_cap * INTERNER_GROWTH;
+    if (interner->next_ctrl_bytes == NULL) {
+        if (!alloc_table(interner, next_cap, &interner->next_ctrl_bytes,
+                         &interner->next_hashset)) {
+            panic("ran out of space while allocating string hashset");
+        }
+        interner->next_cleared = 0;
     }
 
-    memset(new_ctrl_bytes, kEmpty, new_cap * sizeof(u8));
-
-    for (size_t old_pos = 0; old_pos < old_cap; ++old_pos) {
-        if (old_ctrl_bytes[old_pos] != kEmpty) {
-            size_t hash = old_hashset[old_pos].hash;
-            size_t new_pos = H1(hash) % new_cap;
-            size_t new_lim =
-                new_pos == 0 ? (interner->hashset_cap - 1) : (new_pos - 1);
+    size_t left = next_cap - interner->next_cleared;
+    bytes = bytes < left ? bytes : left;
+    memset(interner->next_ctrl_bytes + interner->next_cleared, kEmpty, bytes);
+    interner->next_cleared += bytes;
+}
 
-            do {
-                if (new_ctrl_bytes[new_pos] == kEmpty) {
-                    new_ctrl_bytes[new_pos] = old_ctrl_bytes[old_pos];
-                    new_hashset[new_pos] = old_hashset[old_pos];
-                    break;
-                }
-
-                new_pos = (new_pos + 1) % new_cap;
-            } while (new_pos != new_lim);
+// Moves the entries of up to `slots` old slots to the new table. A moved
+// slot becomes kDeleted rather than kEmpty, so probes in the old table still
+// get past it.
+static void migrate_entries(interner_t *interner, size_t slots) {
+    size_t end = interner->migrate_at + slots;
+    end = end < interner->old_cap ? end : interner->old_cap;
+
+    size_t group_mask = GROUP_MASK(interner);
+    for (size_t pos = interner->migrate_at; pos < end; ++pos) {
+        if ((interner->old_ctrl_bytes[pos] & kEmpty) == 0) {
+            insert_entry(interner->ctrl_bytes, interner->hashset, group_mask,
+                         interner->old_hashset[pos]);
+            interner->old_ctrl_bytes[pos] = kDeleted;
         }
     }
+    interner->migrate_at = end;
 
-    interner->ctrl_bytes = new_ctrl_bytes;
-    interner->hashset = new_hashset;
-    interner->hashset_occ = interner->hashset_occ;
-
-    interner->allocator.free(old_ctrl_bytes);
+    if (end == interner->old_cap) {
+        interner->allocator.free(interner->old_ctrl_bytes); // and old_hashset
+        interner->old_ctrl_bytes = NULL;
+        interner->old_hashset = NULL;
+        interner->old_cap = 0;
+    }
 }
 
-byte_slice find_or_insert(interner_t *interner, byte_slice allocated,
-                          size_t revert) {
+// Starts growing the table. The current one is kept for lookups until
+// migrate_entries has moved everything out of it, MIGRATE_SLOTS per insert,
+// so no insert pays for rehashing the whole set.
+static void grow_table(interner_t *interner) {
+    if (interner->old_ctrl_bytes != NULL) {
+        // only when the load factor is tiny: finish the previous move first
+        migrate_entries(interner, interner->old_cap);
+    }
 
-    size_t hash = stbds_hash_string(allocated.at, interner->seed);
-    size_t pos = H1(hash) % interner->hashset_cap;
-    size_t start = pos;
+    // usually cleared by now, unless the table was too small to bother
+    prepare_table(interner, SIZE_MAX);
 
-    do {
-        byte_slice candidate = interner->hashset[pos].rawptr;
+    interner->old_ctrl_bytes = interner->ctrl_bytes;
+    interner->old_hashset = interner->hashset;
+    interner->old_cap = interner->hashset_cap;
+    interner->migrate_at = 0;
 
-        bool cmp_res;
+    interner->ctrl_bytes = interner->next_ctrl_bytes;
+    interner->hashset = interner->next_hashset;
+    interner->hashset_cap *= INTERNER_GROWTH;
+    interner->next_ctrl_bytes = NULL;
+    interner->next_hashset = NULL;
+    STAT(if (interner->stats != NULL) { interner->stats->rebuilds += 1; });
+}
 
-        if (H2(hash) == interner->ctrl_bytes[pos] &&
-            hash == interner->hashset[pos].hash &&
-            (cmp_res = bytes_strict_eq(candidate, allocated))) {
-            // case 1, found:
-            interner->next_string = revert; // string already stored:
-                                            // discard temp allocation
-            return candidate;
+// the copy of `source` in one table, NULL if there is none. With AG_STATS,
+// `groups` is set to the number of groups probed.
+static set_entry_t *find_in_table(u8 const *ctrl_bytes, set_entry_t *hashset,
+                                  size_t cap, byte_slice source, size_t hash,
+                                  size_t *groups) {
+    (void)groups; // only written with AG_STATS
+    size_t group_mask = cap / GROUP_WIDTH - 1;
+    size_t group = H1(hash) & group_mask;
+
+    for (size_t step = 1; step <= group_mask + 1; ++step) {
+        STAT(*groups = step);
+        u8 const *ctrl = ctrl_bytes + group * GROUP_WIDTH;
+        set_entry_t *entries = hashset + group * GROUP_WIDTH;
+
+        for (group_mask_t match = group_match(ctrl, H2(hash)); match != 0;
+             match &= match - 1) {
+            set_entry_t *entry = &entries[ag_ctz64(match)];
+            if (entry->hash == hash && stored_eq(entry->rawptr, source)) {
+                return entry;
+            }
         }
 
-        if (interner->ctrl_bytes[pos] == kEmpty) {
-            interner->ctrl_bytes[pos] = H2(hash);
-            interner->hashset[pos] =
-                (set_entry_t){.hash = hash, .rawptr = allocated};
-            interner->hashset_occ += 1;
-
-            return allocated;
-        };
-
-        pos = (pos + 1) % interner->hashset_cap;
-        if (pos == start) {
-            break;
+        if (group_match_empty(ctrl) != 0) {
+            return NULL;
         }
-    } while (true);
+        group = (group + step) & group_mask;
+    }
 
-    panic("unreachable codepath");
+    return NULL;
 }
 
-byte_slice intern_string(interner_t *interner, byte_slice source) {
-    if (interner->next_string == UINT64_MAX) {
-        panic("global string interner uninitialised");
+// the interned copy of `source`, NULL if there is none yet
+static set_entry_t *find_entry(interner_t *interner, byte_slice source,
+                               size_t hash) {
+    size_t groups = 0;
+    size_t old_groups = 0;
+    set_entry_t *found =
+        find_in_table(interner->ctrl_bytes, interner->hashset,
+                      interner->hashset_cap, source, hash, &groups);
+    if (found == NULL && interner->old_ctrl_bytes != NULL) {
+        found = find_in_table(interner->old_ctrl_bytes, interner->old_hashset,
+                              interner->old_cap, source, hash, &old_groups);
     }
-    u8 *pool;
-    size_t pool_size;
+    STAT(if (interner->stats != NULL) {
+        groups += old_groups;
+        groups = groups < AG_PROBE_BUCKETS ? groups : AG_PROBE_BUCKETS;
+        interner->stats->probes[groups - 1] += 1;
+    });
+    return found;
+}
 
-    for (int i = 0; i <= interner->pool_at; ++i) {
-        pool = interner->pools[i];
-        pool_size = interner->pool_sizes[i];
+/*
+Known keys: hash and displace (Belazzougui, Botelho and Dietzfelbinger).
+The keys are split into buckets by their hash, and every bucket gets a
+displacement (d1, d2) that sends each of its keys, at f1 + d1 * f2 + d2, to
+a slot no other key uses. Large buckets are placed first, while most slots
+are free. A lookup is then one bucket, one slot and one compare, with the
+hash the table would use anyway.
+*/
+#define KNOWN_BUCKET_KEYS 4
+#define KNOWN_MAX_KEYS (1u << 15) // d1 and d2 are 16 bits
 
-        if (source.at >= pool && source.at < pool + pool_size) {
-            return source;
-        }
+static size_t known_bucket(interner_t const *interner, size_t hash) {
+    return (hash >> 32) & (interner->known_buckets - 1);
+}
+
+static size_t known_slot(interner_t const *interner, size_t hash, u32 disp) {
+    size_t d1 = disp >> 16;
+    size_t d2 = disp & 0xFFFFu;
+    return (hash + d1 * ((hash >> 16) | 1) + d2) & (interner->known_cap - 1);
+}
+
+// the known key equal to `source`, NULL if it is not one
+static set_entry_t *find_known(interner_t const *interner, byte_slice source,
+                               size_t hash) {
+    u32 disp = interner->known_disp[known_bucket(interner, hash)];
+    set_entry_t *entry = &interner->known[known_slot(interner, hash, disp)];
+    if (entry->hash == hash && entry->rawptr.at != NULL &&
+        stored_eq(entry->rawptr, source)) {
+        return entry;
     }
-    u8 *base = interner->current_pool + interner->next_string;
-    size_t temp_next_string = interner->next_string;
+    return NULL;
+}
 
-    size_t real_length = source.len + 1;
-    if (interner->next_string + real_length > interner->current_pool_size) {
+// A reservation is a single pool that never moves, it only commits more of
+// itself: twice as much as before, or what `needed` takes.
+static void commit_more(interner_t *interner, size_t needed) {
+    size_t committed = interner->current_pool_size;
+    size_t target = committed * 2 > needed ? committed * 2 : needed;
+    target = ROUND_UP(target, COMMIT_GRANULE);
+    target = target < interner->reserve ? target : interner->reserve;
+    if (needed > target ||
+        !ag_commit(interner->reserved + committed, target - committed)) {
+        panic("ran out of space while allocating string pool");
+    }
+    interner->current_pool_size = target;
+}
+
+#define MAX_SHARDS 256u
+// smallest table a shard or a small document starts with
+#define MIN_TABLE_ENTRIES 256u
+// input bytes per slot when a table is sized for an input, most documents
+// repeat their keys
+#define BYTES_PER_ENTRY 32u
+
+// room for `size` bytes in the current pool, starting a new one if needed
+static u8 *pool_alloc(interner_t *interner, size_t size) {
+    if (interner->reserved != NULL &&
+        interner->next_string + size > interner->current_pool_size) {
+        commit_more(interner, interner->next_string + size);
+    } else if (interner->next_string + size > interner->current_pool_size) {
         // make new pool
-        size_t min = real_length;
+        size_t min = size;
         size_t hint = interner->current_pool_size * 2;
 
         u8 *new_buf;
@@ -260,8 +553,9 @@ byte_slice intern_string(interner_t *interner, byte_slice source) {
             interner->allocator.free(interner->pools);
             interner->allocator.free(interner->pool_sizes);
 
-            interner->pools = new_pools;
-            interner->pool_sizes = new_pool_sizes;
+            interner->pools = (u8 **)new_pools;
+            interner->pool_sizes = (size_t *)new_pool_sizes;
+            interner->max_pools *= 2;
         }
 
         interner->pool_at += 1;
@@ -271,31 +565,417 @@ byte_slice intern_string(interner_t *interner, byte_slice source) {
         interner->current_pool = new_buf;
         interner->current_pool_size = buf_size;
         interner->next_string = 0;
+    }
+
+    u8 *base = interner->current_pool + interner->next_string;
+    interner->next_string += size;
+    return base;
+}
 
-        base = new_buf + 0;
+// the next id, making room for it in `strings`
+static agnes_string_t next_id(interner_t *interner) {
+    if (interner->string_count == UINT32_MAX >> interner->id_shift) {
+        panic("too many strings to number with 32 bits");
     }
+    if (interner->string_count + 1 >= interner->strings_cap) {
+        size_t cap = interner->strings_cap * 2;
+        u8 *strings;
+        if (!interner->allocator.alloc(cap * sizeof(byte_slice), &strings)) {
+            panic("out of space while allocating array for string lookup");
+        }
+        memcpy(strings, interner->strings,
+               interner->strings_cap * sizeof(byte_slice));
+        interner->allocator.free((u8 *)interner->strings);
+        interner->strings = (byte_slice *)strings;
+        interner->strings_cap = cap;
+    }
+    return (agnes_string_t)++interner->string_count;
+}
 
-    memcpy(base, source.at, source.len);
+// whether `source` is a string this interner stored
+static bool owns_string(interner_t const *interner, byte_slice source) {
+    if (interner->known_cap != 0 && source.at >= interner->known_strings &&
+        source.at < interner->known_strings + interner->known_size) {
+        return true;
+    }
+    if (interner->reserved != NULL) {
+        return source.at >= interner->reserved &&
+               source.at < interner->reserved + interner->reserve;
+    }
+
+    u8 *pool;
+    size_t pool_size;
+
+    for (int i = 0; i <= interner->pool_at; ++i) {
+        pool = interner->pools[i];
+        pool_size = interner->pool_sizes[i];
+
+        if (source.at >= pool && source.at < pool + pool_size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static byte_slice intern_hashed(interner_t *interner, byte_slice source,
+                                size_t hash) {
+    // looked up in place: a string seen before is never copied
+    if (interner->known_cap != 0) {
+        set_entry_t *known = find_known(interner, source, hash);
+        if (known != NULL) {
+            return known->rawptr;
+        }
+    }
+    set_entry_t *found = find_entry(interner, source, hash);
+    if (found != NULL) {
+        return found->rawptr;
+    }
+
+    agnes_string_t local = next_id(interner);
+    agnes_string_t id = local << interner->id_shift | interner->id_tag;
+    size_t real_length = source.len + 1;
+    u8 *base = pool_alloc(interner, sizeof(id) + real_length);
+    memcpy(base, &id, sizeof(id));
+    base += sizeof(id);
+    if (base != source.at) { // else written in place, see intern_scratch
+        memcpy(base, source.at, source.len);
+    }
     base[real_length - 1] = '\0';
-    interner->next_string += real_length;
 
     byte_slice allocated = {base, real_length};
+    interner->strings[local] = allocated;
+    STAT(if (interner->stats != NULL) {
+        interner->stats->unique += 1;
+        interner->stats->unique_bytes += source.len;
+    });
 
-    double upper_bound = ((double)interner->hashset_cap) * 0.75;
+    double upper_bound = (double)interner->hashset_cap * interner->max_load;
     if ((double)(interner->hashset_occ + 1) > upper_bound) {
-        rebuild_table(interner);
+        grow_table(interner);
+    } else if ((double)(interner->hashset_occ + 1) > upper_bound / 2) {
+        prepare_table(interner, PREPARE_BYTES);
+    }
+    if (interner->old_ctrl_bytes != NULL) {
+        migrate_entries(interner, MIGRATE_SLOTS);
     }
 
-    return find_or_insert(interner, allocated, temp_next_string);
+    insert_entry(interner->ctrl_bytes, interner->hashset, GROUP_MASK(interner),
+                 (set_entry_t){.hash = hash, .rawptr = allocated});
+    interner->hashset_occ += 1;
+    return allocated;
 }
 
-bool init_global_interner(interner_t *interner, allocator_t allocator,
-                          size_t init_string_pool_size) {
-    interner->next_string = UINT64_MAX;
+static interner_shard_t *shard_of_hash(interner_t const *interner,
+                                       size_t hash) {
+    return &interner->shards[hash >> (64 - interner->id_shift)];
+}
+
+static interner_shard_t *shard_of_id(interner_t const *interner,
+                                     agnes_string_t id) {
+    return &interner->shards[id & ((1u << interner->id_shift) - 1)];
+}
+
+static byte_slice intern_shared(interner_t *interner, byte_slice source) {
+    // the known keys belong to the parent, they never change after init
+    if (interner->known_cap != 0 && source.at >= interner->known_strings &&
+        source.at < interner->known_strings + interner->known_size) {
+        return source;
+    }
+
+    // A string returned before counts its NUL in .len, but was hashed
+    // without it: only the shard that hash picks can own it.
+    if (source.len > 0 && source.at[source.len - 1] == '\0') {
+        byte_slice text = {source.at, source.len - 1};
+        interner_shard_t *shard =
+            shard_of_hash(interner, hash_bytes(text, interner->seed));
+        ag_mutex_lock(&shard->lock);
+        bool owned = owns_string(&shard->interner, source);
+        ag_mutex_unlock(&shard->lock);
+        if (owned) {
+            return source;
+        }
+    }
+
+    size_t hash = hash_bytes(source, interner->seed);
+    if (interner->known_cap != 0) {
+        set_entry_t *known = find_known(interner, source, hash);
+        if (known != NULL) {
+            return known->rawptr;
+        }
+    }
+    interner_shard_t *shard = shard_of_hash(interner, hash);
+    ag_mutex_lock(&shard->lock);
+    byte_slice interned = owns_string(&shard->interner, source)
+                              ? source
+                              : intern_hashed(&shard->interner, source, hash);
+    ag_mutex_unlock(&shard->lock);
+    return interned;
+}
+
+static byte_slice intern_uncounted(interner_t *interner, byte_slice source) {
+    if (interner->next_string == UINT64_MAX) {
+        panic("global string interner uninitialised");
+    }
+
+    if (interner->shards != NULL) {
+        return intern_shared(interner, source);
+    }
+
+    if (owns_string(interner, source)) {
+        return source;
+    }
+    return intern_hashed(interner, source, hash_bytes(source, interner->seed));
+}
+
+byte_slice intern_string(interner_t *interner, byte_slice source) {
+#if AG_STATS
+    agnes_stats_t *stats = interner->stats;
+    if (stats != NULL) {
+        u64 start = ag_now_ns();
+        byte_slice interned = intern_uncounted(interner, source);
+        stats->intern_ns += ag_now_ns() - start;
+        stats->strings += 1;
+        stats->bytes += interned.len - 1;
+        return interned;
+    }
+#endif
+    return intern_uncounted(interner, source);
+}
+
+// Room for a string of up to `max_len` bytes, right where the next string
+// will be stored. Write it there and pass it to intern_in_place before
+// interning anything else: if the string is new it is kept without a copy.
+// For strings that are only known once decoded (JSON escapes), not for
+// shared interners.
+u8 *intern_scratch(interner_t *interner, size_t max_len) {
+    if (interner->shards != NULL) {
+        panic("intern_scratch on a shared interner");
+    }
+    size_t size = sizeof(agnes_string_t) + max_len + 1;
+    u8 *base = pool_alloc(interner, size);
+    interner->next_string -= size; // claimed by intern_in_place, if new
+    return base + sizeof(agnes_string_t);
+}
+
+byte_slice intern_in_place(interner_t *interner, u8 *scratch, size_t len) {
+    byte_slice source = {scratch, len};
+#if AG_STATS
+    agnes_stats_t *stats = interner->stats;
+    if (stats != NULL) {
+        u64 start = ag_now_ns();
+        byte_slice interned = intern_hashed(interner, source,
+                                            hash_bytes(source, interner->seed));
+        stats->intern_ns += ag_now_ns() - start;
+        stats->strings += 1;
+        stats->bytes += len;
+        return interned;
+    }
+#endif
+    return intern_hashed(interner, source, hash_bytes(source, interner->seed));
+}
+
+#if AG_STATS
+// the pools' share of the stats, as they are now
+static void count_pools(interner_t const *interner, agnes_stats_t *stats) {
+    if (interner->shards != NULL) {
+        for (size_t i = 0; i < interner->shard_count; ++i) {
+            count_pools(&interner->shards[i].interner, stats);
+        }
+    } else if (interner->reserved != NULL) {
+        stats->pools += 1;
+        stats->pool_bytes += interner->current_pool_size;
+    } else {
+        for (size_t i = 0; i <= interner->pool_at; ++i) {
+            stats->pools += 1;
+            stats->pool_bytes += interner->pool_sizes[i];
+        }
+    }
+    // the known keys (up to `permanent`) are not in the pools
+    for (size_t i = interner->permanent + 1; i <= interner->string_count; ++i) {
+        stats->pool_used += sizeof(agnes_string_t) + interner->strings[i].len;
+    }
+}
+#endif
+
+#define KNOWN_MAX_TRIES (1u << 20) // per bucket, before the table doubles
+#define NO_KEY UINT32_MAX
+
+// Finds a displacement for the bucket of keys starting at `key` (linked by
+// `next`) that puts them in free, distinct slots, and fills those slots.
+static bool place_bucket(interner_t *interner, set_entry_t const *entries,
+                         u32 key, u32 const *next, u32 *disp) {
+    for (u32 k = key; k != NO_KEY; k = next[k]) {
+        for (u32 other = next[k]; other != NO_KEY; other = next[other]) {
+            if (entries[k].hash == entries[other].hash &&
+                entries[k].rawptr.len == entries[other].rawptr.len &&
+                memcmp(entries[k].rawptr.at, entries[other].rawptr.at,
+                       entries[k].rawptr.len) == 0) {
+                panic("known keys list \"%s\" twice", entries[k].rawptr.at);
+            }
+        }
+    }
+
+    size_t limit = interner->known_cap < 0x10000 ? interner->known_cap
+                                                 : 0x10000;
+    for (size_t attempt = 0; attempt < KNOWN_MAX_TRIES; ++attempt) {
+        *disp = (u32)((attempt / limit) << 16 | attempt % limit);
+        u32 k = key;
+        for (; k != NO_KEY; k = next[k]) {
+            set_entry_t *slot =
+                &interner->known[known_slot(interner, entries[k].hash, *disp)];
+            if (slot->rawptr.at != NULL) {
+                break;
+            }
+            *slot = entries[k];
+        }
+        if (k == NO_KEY) {
+            return true;
+        }
+        for (u32 undo = key; undo != k; undo = next[undo]) {
+            interner->known[known_slot(interner, entries[undo].hash, *disp)] =
+                (set_entry_t){0};
+        }
+    }
+    return false;
+}
+
+// builds the perfect hash over `cap` slots, false if some bucket won't fit
+static bool place_known(interner_t *interner, set_entry_t const *entries,
+                        size_t count, size_t cap) {
+    allocator_t allocator = interner->allocator;
+    size_t buckets = 1;
+    while (buckets * KNOWN_BUCKET_KEYS < count) {
+        buckets *= 2;
+    }
+    interner->known_cap = cap;
+    interner->known_buckets = buckets;
+
+    u32 *links; // per bucket: its first key and how many it has, per key: the
+                // next key in its bucket
+    if (!allocator.alloc(cap * sizeof(set_entry_t), (u8 **)&interner->known) ||
+        !allocator.alloc(buckets * sizeof(u32),
+                         (u8 **)&interner->known_disp) ||
+        !allocator.alloc((2 * buckets + count) * sizeof(u32), (u8 **)&links)) {
+        panic("ran out of space while allocating known keys");
+    }
+    memset(interner->known, 0, cap * sizeof(set_entry_t));
+    memset(interner->known_disp, 0, buckets * sizeof(u32));
+    u32 *heads = links;
+    u32 *sizes = links + buckets;
+    u32 *next = links + 2 * buckets;
+    memset(heads, 0xFF, buckets * sizeof(u32));
+    memset(sizes, 0, buckets * sizeof(u32));
+
+    u32 max_size = 0;
+    for (u32 i = 0; i < count; ++i) {
+        size_t bucket = known_bucket(interner, entries[i].hash);
+        next[i] = heads[bucket];
+        heads[bucket] = i;
+        sizes[bucket] += 1;
+        max_size = sizes[bucket] > max_size ? sizes[bucket] : max_size;
+    }
+
+    bool placed = true;
+    for (u32 size = max_size; size > 0 && placed; --size) {
+        for (size_t bucket = 0; bucket < buckets && placed; ++bucket) {
+            if (sizes[bucket] == size) {
+                placed = place_bucket(interner, entries, heads[bucket], next,
+                                      &interner->known_disp[bucket]);
+            }
+        }
+    }
+
+    allocator.free((u8 *)links);
+    if (!placed) {
+        allocator.free((u8 *)interner->known);
+        allocator.free((u8 *)interner->known_disp);
+    }
+    return placed;
+}
+
+// Stores the known keys in a block of their own and builds their perfect
+// hash in `interner`. Their ids come from `numbered`, which keeps them across
+// resets: `interner` itself, or the first shard of a shared interner.
+static bool init_known(interner_t *interner, interner_t *numbered) {
+    char const *const *keys = interner->known_keys;
+    size_t count = interner->known_key_count;
+    allocator_t allocator = interner->allocator;
+    interner->known_cap = 0;
+    if (count == 0) {
+        return true;
+    }
+    if (count > KNOWN_MAX_KEYS) {
+        panic("too many known keys (at most %u)", KNOWN_MAX_KEYS);
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += sizeof(agnes_string_t) + strlen(keys[i]) + 1;
+    }
+    set_entry_t *entries;
+    if (!allocator.alloc(size, &interner->known_strings)) {
+        return false;
+    }
+    if (!allocator.alloc(count * sizeof(set_entry_t), (u8 **)&entries)) {
+        allocator.free(interner->known_strings);
+        return false;
+    }
+    interner->known_size = size;
+
+    u8 *at = interner->known_strings;
+    for (size_t i = 0; i < count; ++i) {
+        byte_slice key = {(u8 *)keys[i], strlen(keys[i])};
+        agnes_string_t local = next_id(numbered);
+        agnes_string_t id = local << numbered->id_shift | numbered->id_tag;
+        memcpy(at, &id, sizeof(id));
+        at += sizeof(id);
+        memcpy(at, key.at, key.len);
+        at[key.len] = '\0';
+
+        byte_slice stored = {at, key.len + 1};
+        numbered->strings[local] = stored;
+        entries[i] = (set_entry_t){.hash = hash_bytes(key, interner->seed),
+                                   .rawptr = stored};
+        at += key.len + 1;
+    }
+    numbered->permanent = numbered->string_count;
+
+    size_t cap = GROUP_WIDTH;
+    while (cap < 2 * count) {
+        cap *= 2;
+    }
+    while (!place_known(interner, entries, count, cap)) {
+        cap *= 2;
+    }
+
+    allocator.free((u8 *)entries);
+    return true;
+}
+
+// the strings' one pool: the start of a fresh reservation
+static bool init_reservation(interner_t *interner, size_t commit) {
+    interner->reserve = ROUND_UP(interner->reserve, COMMIT_GRANULE);
+    commit = ROUND_UP(commit, COMMIT_GRANULE);
+    commit = commit < interner->reserve ? commit : interner->reserve;
+
+    interner->reserved = ag_reserve(interner->reserve);
+    if (interner->reserved == NULL || !ag_commit(interner->reserved, commit)) {
+        return false;
+    }
+
+    interner->current_pool = interner->reserved;
+    interner->current_pool_size = commit;
+    interner->pools = NULL;
+    interner->pool_sizes = NULL;
+    interner->pool_at = 0;
+    interner->max_pools = 0;
+    return true;
+}
 
+static bool init_pools(interner_t *interner, allocator_t allocator,
+                       size_t init_string_pool_size) {
     u8 *buffer;
-    if (allocator.alloc == NULL ||
-        !allocator.alloc(init_string_pool_size, &buffer)) {
+    if (!allocator.alloc(init_string_pool_size, &buffer)) {
         return false;
     }
 
@@ -316,55 +996,263 @@ bool init_global_interner(interner_t *interner, allocator_t allocator,
 
     interner->pools = (u8 **)pools;
 
-    interner->pool_sizes = (u8 **)pool_sizes;
+    interner->pool_sizes = (size_t *)pool_sizes;
 
     interner->pool_at = 0;
     interner->pools[interner->pool_at] = interner->current_pool;
     interner->pool_sizes[interner->pool_at] = interner->current_pool_size;
+    return true;
+}
+
+static bool init_interner(interner_t *interner, allocator_t allocator,
+                          size_t init_string_pool_size, size_t table_cap);
+
+// Every shard is a whole interner with the parent's seed, so the hash that
+// picks a shard is the one its table uses.
+static bool init_shards(interner_t *interner, size_t init_string_pool_size) {
+    u32 shift = 1;
+    while ((1u << shift) < interner->shard_count &&
+           (1u << shift) < MAX_SHARDS) {
+        ++shift;
+    }
+    size_t count = (size_t)1 << shift;
+
+    interner_shard_t *shards;
+    if (!interner->allocator.alloc(count * sizeof(interner_shard_t),
+                                   (u8 **)&shards)) {
+        return false;
+    }
+
+    // the parent's sizes split up, so that a shared interner starts out no
+    // bigger than a plain one
+    size_t pool_size = init_string_pool_size / count;
+    pool_size = pool_size < KiB(4) ? KiB(4) : pool_size;
+    size_t table_cap = HASH_SET_ENTRIES / count;
+    table_cap = table_cap < MIN_TABLE_ENTRIES ? MIN_TABLE_ENTRIES : table_cap;
+    for (size_t i = 0; i < count; ++i) {
+        interner_t *shard = &shards[i].interner;
+        *shard = (interner_t){.max_load = interner->max_load,
+                              .reserve = interner->reserve / count};
+        if (!init_interner(shard, interner->allocator, pool_size,
+                           table_cap)) {
+            return false;
+        }
+        shard->seed = interner->seed;
+        shard->id_shift = shift;
+        shard->id_tag = (u32)i;
+        ag_mutex_init(&shards[i].lock);
+    }
+
+    interner->shards = shards;
+    interner->shard_count = count;
+    interner->id_shift = shift;
+    return true;
+}
+
+static bool init_interner(interner_t *interner, allocator_t allocator,
+                          size_t init_string_pool_size, size_t table_cap) {
+    interner->next_string = UINT64_MAX;
+    interner->reserved = NULL;
+    interner->shards = NULL;
+    interner->id_shift = 0;
+    interner->id_tag = 0;
+    if (allocator.alloc == NULL) {
+        return false;
+    }
 
     interner->allocator = allocator;
     time_t temp_time;
     time(&temp_time);
     interner->seed = *(size_t *)&temp_time;
 
-    set_entry_t *string_set;
-    u8 *ctrl_bytes;
-
-    interner->hashset_cap = HASH_SET_ENTRIES;
-
-    size_t buffer_size = HASH_SET_ENTRIES * (sizeof(set_entry_t) + sizeof(u8));
+    if (interner->shard_count > 1) {
+        if (!init_shards(interner, init_string_pool_size) ||
+            !init_known(interner, &interner->shards[0].interner)) {
+            return false;
+        }
+        interner->next_string = 0;
+        return true;
+    }
 
-    if (!allocator.alloc(buffer_size, &ctrl_bytes)) { // same allocation
+    bool pooled = interner->reserve > 0
+                      ? init_reservation(interner, init_string_pool_size)
+                      : init_pools(interner, allocator, init_string_pool_size);
+    if (!pooled) {
         return false;
     }
 
-    memset(ctrl_bytes, kEmpty, interner->hashset_cap * sizeof(u8));
+    u8 *strings;
+    if (!allocator.alloc(STRING_ARRAY_SIZE * sizeof(byte_slice), &strings)) {
+        return false;
+    }
+    interner->strings = (byte_slice *)strings;
+    interner->strings_cap = STRING_ARRAY_SIZE;
+    interner->string_count = 0;
+    interner->permanent = 0;
+
+    interner->hashset_cap = table_cap;
+    interner->hashset_occ = 0;
+    interner->old_ctrl_bytes = NULL;
+    interner->old_hashset = NULL;
+    interner->old_cap = 0;
+    interner->next_ctrl_bytes = NULL;
+    interner->next_hashset = NULL;
+
+    if (!alloc_table(interner, interner->hashset_cap, &interner->ctrl_bytes,
+                     &interner->hashset)) {
+        return false;
+    }
+    memset(interner->ctrl_bytes, kEmpty, interner->hashset_cap * sizeof(u8));
 
-    string_set = ctrl_bytes + interner->hashset_cap * sizeof(u8);
+    // probes need an empty slot to end on, and growing must finish moving
+    // the old table before the new one fills up
+    if (interner->max_load <= 0.0) {
+        interner->max_load = INTERNER_MAX_LOAD;
+    }
+    interner->max_load = interner->max_load < 0.05 ? 0.05 : interner->max_load;
+    interner->max_load = interner->max_load > 0.9 ? 0.9 : interner->max_load;
 
-    interner->hashset = string_set;
-    interner->ctrl_bytes = ctrl_bytes;
+    if (!init_known(interner, interner)) {
+        return false;
+    }
 
     // success
     interner->next_string = 0;
     return true;
 }
 
+bool init_global_interner(interner_t *interner, allocator_t allocator,
+                          size_t init_string_pool_size) {
+    return init_interner(interner, allocator, init_string_pool_size,
+                         HASH_SET_ENTRIES);
+}
+
+// a table to start with for `size` bytes of input, it grows from there
+static size_t table_cap_for(size_t size) {
+    size_t cap = MIN_TABLE_ENTRIES;
+    while (cap < HASH_SET_ENTRIES && cap * BYTES_PER_ENTRY < size) {
+        cap *= 2;
+    }
+    return cap;
+}
+
+// Forgets every string but keeps the memory: the table at its size, the id
+// array, and the largest pool (the newest, they double), so the next
+// document interns into space that is already there.
+void reset_interner(interner_t *interner) {
+    if (interner->next_string == UINT64_MAX) {
+        panic("interner uninitialised");
+    }
+    if (interner->shards != NULL) {
+        for (size_t i = 0; i < interner->shard_count; ++i) {
+            reset_interner(&interner->shards[i].interner);
+        }
+        return;
+    }
+
+    if (interner->old_ctrl_bytes != NULL) {
+        interner->allocator.free(interner->old_ctrl_bytes); // and old_hashset
+        interner->old_ctrl_bytes = NULL;
+        interner->old_hashset = NULL;
+        interner->old_cap = 0;
+    }
+    // the next table holds nothing but cleared control bytes, it stays
+    if (interner->hashset_occ > 0) {
+        memset(interner->ctrl_bytes, kEmpty,
+               interner->hashset_cap * sizeof(u8));
+    }
+    interner->hashset_occ = 0;
+    interner->string_count = interner->permanent;
+
+    if (interner->reserved == NULL) {
+        for (size_t i = 0; i < interner->pool_at; ++i) {
+            interner->allocator.free(interner->pools[i]);
+        }
+        interner->pools[0] = interner->current_pool;
+        interner->pool_sizes[0] = interner->current_pool_size;
+        interner->pool_at = 0;
+    }
+    interner->next_string = 0;
+}
+
 void free_and_invalidate(interner_t *interner) {
     if (interner->next_string == UINT64_MAX) {
         panic("interner uninitialised");
     }
 
     interner->next_string = UINT64_MAX;
-    for (int i = 0; i < interner->pool_at; ++i) {
-        u8 *pool = interner->pools[i];
-        interner->allocator.free(pool);
+    if (interner->known_cap != 0) {
+        interner->allocator.free((u8 *)interner->known);
+        interner->allocator.free((u8 *)interner->known_disp);
+        interner->allocator.free(interner->known_strings);
+        interner->known_cap = 0;
+    }
+    if (interner->shards != NULL) {
+        for (size_t i = 0; i < interner->shard_count; ++i) {
+            free_and_invalidate(&interner->shards[i].interner);
+            ag_mutex_destroy(&interner->shards[i].lock);
+        }
+        interner->allocator.free((u8 *)interner->shards);
+        interner->shards = NULL;
+        return;
     }
 
+    if (interner->reserved != NULL) {
+        ag_release(interner->reserved, interner->reserve);
+        interner->reserved = NULL;
+    } else {
+        for (size_t i = 0; i <= interner->pool_at; ++i) {
+            u8 *pool = interner->pools[i];
+            interner->allocator.free(pool);
+        }
+        interner->allocator.free((u8 *)interner->pools);
+        interner->allocator.free((u8 *)interner->pool_sizes);
+    }
+
+    interner->allocator.free((u8 *)interner->strings);
     interner->allocator.free(interner->ctrl_bytes); // frees hashset, too
+    if (interner->old_ctrl_bytes != NULL) {
+        interner->allocator.free(interner->old_ctrl_bytes);
+        interner->old_ctrl_bytes = NULL;
+    }
+    if (interner->next_ctrl_bytes != NULL) {
+        interner->allocator.free(interner->next_ctrl_bytes);
+        interner->next_ctrl_bytes = NULL;
+    }
 }
 
 bool str_eq(byte_slice left, byte_slice right) { return left.at == right.at; }
 
-#endif
+// the id of a string returned by intern_string
+agnes_string_t string_id(byte_slice interned) {
+    agnes_string_t id;
+    memcpy(&id, interned.at - sizeof(id), sizeof(id));
+    return id;
+}
+
+agnes_string_t intern_id(interner_t *interner, byte_slice source) {
+    return string_id(intern_string(interner, source));
+}
+
+// the string as intern_string returned it: NUL-terminated, with .len
+// counting the NUL
+byte_slice string_of(interner_t const *interner, agnes_string_t id) {
+    if (interner->shards != NULL) {
+        interner_shard_t *shard = shard_of_id(interner, id);
+        ag_mutex_lock(&shard->lock);
+        byte_slice string = string_of(&shard->interner, id);
+        ag_mutex_unlock(&shard->lock);
+        return string;
+    }
+
+    size_t local = id >> interner->id_shift;
+    assert(local > 0 && local <= interner->string_count);
+    return interner->strings[local];
+}
+
+// in bytes, without the NUL
+size_t string_len(interner_t const *interner, agnes_string_t id) {
+    return string_of(interner, id).len - 1;
+}
+
 #endif
\ No newline at end of file
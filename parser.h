@@ -1,8 +1,11 @@
 #if !defined(AG_PARSER_H)
 #define AG_PARSER_H
 
+#include "arena.h"
 #include "common.h"
+#include "interner.h"
 #include <assert.h>
+#include <math.h>
 
 typedef enum token_type {
     T_NONE = 0u,
@@ -36,6 +39,26 @@ typedef struct token {
     };
 } token_t;
 
+#if defined(AG_LARGE_INPUT)
+typedef u64 token_word_t; // inputs over 4 GiB, 16-byte packed tokens
+#else
+typedef u32 token_word_t;
+#endif
+
+// Tokens as kept in the token array: 8 bytes instead of the 24 of a token_t.
+// Only where the token is in the input is stored, strings and numbers are
+// read (and interned) from there when they reach the tape.
+typedef struct packed_token {
+    token_word_t offset;   // of the token's first byte in the input
+    token_word_t kind_len; // PACKED_KIND_BITS of kind, the length above them
+} packed_token_t;
+
+#define PACKED_KIND_BITS 4
+#define PACKED_MAX_LEN (((token_word_t)-1) >> PACKED_KIND_BITS)
+#define PACKED_MAX_INPUT ((token_word_t)-1)
+
+struct parser;
+
 typedef struct lexer {
     struct {
         char const *filename;
@@ -45,21 +68,54 @@ typedef struct lexer {
     size_t position;
     size_t begin_i;
 
-    token_t *tokens;
+    packed_token_t *tokens;
     size_t max_tokens;
     size_t next_token;
 
-    size_t *line_info;
-    size_t current_line;
+    // of bytes[0], errors work out their own from there (see locate)
+    size_t first_line;
+    size_t first_column;
+
+    struct string_interner *interner;
+
+    // when set, tokens go straight to this parser instead of `tokens`
+    struct parser *sink;
+    // `bytes` is only a chunk of the input, more may follow
+    bool partial;
+    // parallel chunks: no token starting here or later is lexed, and no
+    // T_EOF is pushed at the end (0 for the whole input)
+    size_t stop;
 } lexer_t;
 
+typedef struct container_frame {
+    u8 kind; // J_OBJECT or J_ARRAY
+    size_t tape_open;
+} container_frame_t;
+
 typedef struct parser {
     struct {
         char const *filename;
     };
-    token_t *tokens;
+    packed_token_t *tokens;
     size_t len;
     size_t position;
+    u8 const *bytes; // the input `tokens` point into
+    struct string_interner *interner;
+
+    u64 *tape;
+    size_t max_tape;
+    size_t tape_len;
+    bool out_of_space;
+    bool raw_numbers;
+
+    // push parsing (see parse_token), the stack grows through `allocator`
+    container_frame_t *stack;
+    size_t stack_cap;
+    size_t depth;
+    size_t max_depth; // 0 for no limit
+    u8 state;
+    u8 root;
+    allocator_t allocator;
 } parser_t;
 
 typedef enum jvalue_kind {
@@ -74,6 +130,55 @@ typedef enum jvalue_kind {
     J_ERROR,
 } jvalue_kind_t;
 
+/*
+Tape: one 64-bit word per value, laid out in document order.
+The top byte is the jvalue_kind_t of the value (or TAPE_*_END for the end of
+a container) and the low 56 bits are the payload:
+- J_OBJECT/J_ARRAY: index of the matching end word, which in turn holds the
+  index of the opening word.
+- J_STRING: length in bytes. The following word holds a pointer to the bytes
+  in the interner's pools (NUL-terminated).
+- J_NUMBER: the number_kind_t from bit TAPE_NUMBER_SHIFT of the payload up.
+  The following word holds the value (as an i64, u64 or the bits of a
+  double). With `raw_numbers`, numbers are NUMBER_RAW and laid out like
+  strings instead, as their literal text.
+- J_TRUE/J_FALSE/J_NULL: unused.
+Object members are stored as a J_STRING key followed by the value.
+*/
+enum tape_tag {
+    TAPE_OBJECT_END = 0x80 | J_OBJECT,
+    TAPE_ARRAY_END = 0x80 | J_ARRAY,
+};
+
+#define TAPE_TAG_SHIFT 56
+#define TAPE_PAYLOAD_MASK ((((u64)1) << TAPE_TAG_SHIFT) - 1)
+#define TAPE_WORD(tag, payload)                                                \
+    ((((u64)(tag)) << TAPE_TAG_SHIFT) | ((u64)(payload) & TAPE_PAYLOAD_MASK))
+#define TAPE_TAG(word) ((u8)((word) >> TAPE_TAG_SHIFT))
+#define TAPE_PAYLOAD(word) ((word) & TAPE_PAYLOAD_MASK)
+#define TAPE_NUMBER_SHIFT 48
+
+typedef enum number_kind {
+    NUMBER_RAW = 0, // literal text, see tape_string
+    NUMBER_I64,
+    NUMBER_U64, // integers above INT64_MAX
+    NUMBER_F64, // everything else
+} number_kind_t;
+
+typedef struct jnumber {
+    number_kind_t kind;
+    union {
+        i64 i;
+        u64 u;
+        double f;
+    };
+} jnumber_t;
+
+typedef struct tape_iter {
+    u64 const *tape;
+    size_t at;
+} tape_iter_t;
+
 enum agnes_res_kind {
     RES_NONE = 0,
     RES_LEXER_NONE = RES_NONE,
@@ -85,6 +190,12 @@ enum agnes_res_kind {
     RES_PARSER_ERROR,
     RES_PARSER_SOME,
 
+    // streaming only: the chunk ended inside a token
+    RES_LEXER_PARTIAL,
+
+    // agnes_parse_file only: the file could not be opened or mapped
+    RES_IO_ERROR,
+
     RES_OUT_OF_SPACE = 0xFFFF,
 };
 
@@ -92,6 +203,7 @@ typedef struct agnes_result {
     enum agnes_res_kind kind;
     size_t byte_pos;
     size_t line;
+    size_t column; // in bytes, 1-based like `line`
     union {
         token_t fragment;
         jvalue_kind_t jvalue;
@@ -103,20 +215,193 @@ typedef struct agnes_parser {
     u8 const *bytes;
     size_t file_size;
 
-    token_t *tokens;
+    // optional: without it, tokens go straight to the parser
+    packed_token_t *tokens;
     size_t max_tokens;
 
-    size_t *line_info;
-
     allocator_t string_allocator;
+
+    // optional: when set, parse_json fills it as described above
+    // (2 * max_tokens words is always enough).
+    u64 *tape;
+    size_t max_tape;
+    size_t tape_len; // set by parse_json
+    // keep numbers as their text on the tape, tape_number converts them
+    bool raw_numbers;
+
+    // optional: > 1 to tokenize large inputs on that many threads,
+    // `string_allocator` is then called from all of them
+    size_t threads;
+    // optional: reject input that is not valid UTF-8 (RES_LEXER_ERROR at
+    // the first bad byte), checked before tokenizing
+    bool validate_utf8;
+    // optional: deepest nesting of arrays and objects accepted, a
+    // RES_PARSER_ERROR at the container that goes past it (0 for no limit)
+    size_t max_depth;
+
+    // optional: how full the interner's table gets before it grows
+    // (0 for INTERNER_MAX_LOAD)
+    double intern_max_load;
+    // optional: address space to reserve for interned strings, see
+    // interner_t.reserve (0 to allocate pools through string_allocator)
+    size_t intern_reserve;
+    // optional: keys the documents are known to use, e.g. a schema's field
+    // names. They get the ids 1 to known_key_count, in this order, and are
+    // found with a perfect hash instead of the interner's table.
+    char const *const *known_keys;
+    size_t known_key_count;
+
+    // optional: filled by parse_json when compiled with AG_STATS
+    agnes_stats_t *stats;
 } agnes_parser_t;
 
+typedef struct agnes_stream {
+    char const *filename;
+    allocator_t string_allocator;
+
+    // optional, same as in agnes_parser_t
+    u64 *tape;
+    size_t max_tape;
+    size_t tape_len; // set by agnes_finish
+    bool raw_numbers;
+    size_t max_depth;
+    double intern_max_load;
+    size_t intern_reserve;
+    char const *const *known_keys;
+    size_t known_key_count;
+
+    // internal state, carried from one chunk to the next
+    parser_t parser;
+    size_t offset; // of the next chunk in the whole input
+    size_t line;   // and column of the next chunk's first byte
+    size_t column;
+    u8 *carry; // token cut off at the end of the last chunk
+    size_t carry_len;
+    size_t carry_cap;
+    size_t carry_offset;
+    size_t carry_line;
+    size_t carry_column;
+    bool carry_escaped; // carry ends inside a string, after a backslash
+    agnes_result_t error;
+} agnes_stream_t;
+
+// Many documents in a row, one after the other: the session keeps its
+// interner and parser stack between them instead of setting them up for
+// every document like parse_json does.
+typedef struct agnes_session {
+    allocator_t string_allocator;
+    double intern_max_load;        // optional, as in agnes_parser_t
+    size_t intern_reserve;         // optional, as in agnes_parser_t
+    char const *const *known_keys; // optional, as in agnes_parser_t
+    size_t known_key_count;
+
+    // internal state, kept from one document to the next
+    interner_t interner;
+    container_frame_t *stack;
+    size_t stack_cap;
+} agnes_session_t;
+
+// what a thread of parse_ndjson keeps when the batch has `tapes` set
+typedef struct batch_output {
+    interner_t interner;
+    u64 *tape; // the tapes of its records, one after the other
+    size_t max_tape;
+    size_t tape_len;
+} batch_output_t;
+
+typedef struct batch_record {
+    size_t output; // the thread whose tape it is on
+    size_t at;
+    size_t tape_len;
+} batch_record_t;
+
+// newline-delimited JSON: one document per line, parsed on `threads` threads
+typedef struct agnes_batch {
+    u8 const *bytes;
+    size_t size;
+    allocator_t string_allocator;  // called from several threads at once
+    size_t threads;                // 0 for one per core
+    double intern_max_load;        // optional, as in agnes_parser_t
+    size_t intern_reserve;         // optional, per interner
+    char const *const *known_keys; // optional, as in agnes_parser_t
+    size_t known_key_count;
+    // optional: also build a tape for every record, see batch_tape. The tapes
+    // and the strings they point to are kept until agnes_batch_free.
+    bool tapes;
+    bool raw_numbers; // optional, as in agnes_parser_t
+    // optional, with `tapes`: > 1 for the threads to share one interner split
+    // into this many shards, so that a string is stored once and has the same
+    // id in every record (see interner_t.shard_count)
+    size_t shard_count;
+
+    agnes_result_t *results; // one per record, see count_records
+    size_t max_results;
+    size_t record_count; // set by parse_ndjson
+
+    // internal, with `tapes`: one output per thread, one record per result,
+    // and the shared interner with `shard_count`
+    batch_output_t *outputs;
+    size_t output_count;
+    batch_record_t *records;
+    interner_t interner;
+} agnes_batch_t;
+
 // 'public' API
+// Interns into global_string_interner, which each call (and agnes_begin)
+// frees and sets up again: the strings of the previous result, and the tape
+// pointing at them, are no longer valid.
 static agnes_result_t parse_json(agnes_parser_t *agnes_parser);
 
+// parse_json() on the file at `path`, mapped rather than read into a buffer:
+// `bytes` and `file_size` are set to the mapping, which stays valid until
+// agnes_unmap_file. `filename` is set to `path` unless it is already set.
+static agnes_result_t agnes_parse_file(agnes_parser_t *agnes_parser,
+                                       char const *path);
+static void agnes_unmap_file(agnes_parser_t *agnes_parser);
+
+static size_t count_records(u8 const *bytes, size_t size);
+// Frees what the previous parse_ndjson of `batch` kept (see agnes_batch_free)
+// before parsing.
+static agnes_result_t parse_ndjson(agnes_batch_t *batch);
+// The tape of record `record` (0-based, like `results`), which must be a
+// RES_PARSER_SOME, with `tapes` set. `tape_len` may be NULL.
+static tape_iter_t batch_tape(agnes_batch_t const *batch, size_t record,
+                              size_t *tape_len);
+// frees the tapes and strings parse_ndjson kept, `results` stay as they are
+static void agnes_batch_free(agnes_batch_t *batch);
+
+// streaming: agnes_begin, then agnes_feed for every chunk (in order), then
+// agnes_finish. Chunks may be released as soon as agnes_feed returns.
+static bool agnes_begin(agnes_stream_t *stream);
+static agnes_result_t agnes_feed(agnes_stream_t *stream, u8 const *chunk,
+                                 size_t len);
+static agnes_result_t agnes_finish(agnes_stream_t *stream);
+
+// sessions: agnes_session_init once, agnes_session_parse for every document
+// and agnes_session_reset whenever the strings of the documents parsed so far
+// are no longer needed, agnes_session_free at the end. `expected_size` is a
+// typical document's size, the first allocations are sized from it.
+static bool agnes_session_init(agnes_session_t *session, size_t expected_size);
+static agnes_result_t agnes_session_parse(agnes_session_t *session,
+                                          agnes_parser_t *agnes_parser);
+static void agnes_session_reset(agnes_session_t *session);
+static void agnes_session_free(agnes_session_t *session);
+
+// tape traversal, none of these allocate
+static tape_iter_t tape_root(agnes_parser_t const *agnes_parser);
+static jvalue_kind_t tape_kind(tape_iter_t it); // J_NONE past the last child
+static bool tape_at_end(tape_iter_t it);
+static tape_iter_t tape_child(tape_iter_t container);
+static tape_iter_t tape_next(tape_iter_t it);
+static byte_slice tape_string(tape_iter_t it); // J_STRING and raw J_NUMBER
+static agnes_string_t tape_string_id(tape_iter_t it); // the same, as an id
+static jnumber_t tape_number(tape_iter_t it);   // never NUMBER_RAW
+
 // implementation
 #if defined(AG_PARSER_IMPLEMENT)
 
+#define AG_ARENA_IMPLEMENT
+#include "arena.h"
 #define AG_INTERNER_IMPLEMENT
 #include "interner.h"
 
@@ -133,6 +418,20 @@ byte_slice intern_cstring(interner_t *interner, char const *string) {
     return intern_string(interner, slice);
 }
 
+// lexers intern into their own interner, so that lexers running on
+// different threads never share one. Without one, tokens point into the input
+// and are interned later (see tokenize_parallel).
+static byte_slice lex_intern(lexer_t *lexer, byte_slice slice) {
+    if (lexer->interner == NULL) {
+        return slice;
+    }
+    return intern_string(lexer->interner, slice);
+}
+
+#define LEX_INTERN(slice) lex_intern(lexer, slice)
+// the bytes of a token, which only a sink needs (see push_token)
+#define LEX_VALUE(slice) (lexer->sink != NULL ? LEX_INTERN(slice) : (slice))
+
 static u8 *format_jvalue(jvalue_kind_t kind) {
     switch (kind) {
     case J_TRUE:
@@ -153,6 +452,12 @@ static u8 *format_jvalue(jvalue_kind_t kind) {
 
     case J_NUMBER:
         return CSTR("NUMBER");
+
+    case J_NONE:
+        return CSTR("NONE");
+
+    case J_ERROR:
+        return CSTR("ERROR");
     }
 }
 
@@ -199,7 +504,8 @@ static u8 *format_token(token_t t) {
     } break;
 
     case T_NUMBER_LIT: {
-        __fmt("NUMBER(%s)", t.byte_sequence.at);
+        // numbers handed to a sink are not NUL-terminated
+        __fmt("NUMBER(%.*s)", (int)t.byte_sequence.len, t.byte_sequence.at);
         return CSTR(formatted_string);
     } break;
     }
@@ -210,6 +516,20 @@ static enum token_type map_char[256] = {
     [']'] = T_RIGHT_BRACKET, ['{'] = T_LEFT_CURLY, ['}'] = T_RIGHT_CURLY,
 };
 
+enum char_class {
+    CC_OTHER = 0,
+    CC_OP = 0x1,
+    CC_QUOTE = 0x2,
+    CC_WS = 0x4,
+};
+
+static u8 const char_class[256] = {
+    ['['] = CC_OP,    [']'] = CC_OP,    ['{'] = CC_OP,
+    ['}'] = CC_OP,    [':'] = CC_OP,    [','] = CC_OP,
+    ['"'] = CC_QUOTE, [' '] = CC_WS,    ['\t'] = CC_WS,
+    ['\r'] = CC_WS,   ['\n'] = CC_WS,
+};
+
 static u8 consume(lexer_t *lexer) {
     size_t pos = lexer->position;
     if (pos >= lexer->len) {
@@ -219,12 +539,88 @@ static u8 consume(lexer_t *lexer) {
     return lexer->bytes[pos];
 }
 
+static token_type_t const packed_kinds[1 << PACKED_KIND_BITS] = {
+    T_NONE,         T_LEFT_BRACKET, T_RIGHT_BRACKET,
+    T_LEFT_CURLY,   T_RIGHT_CURLY,  T_COMMA,
+    T_COLON,        T_TRUE,         T_FALSE,
+    T_NULL,         T_NUMBER_LIT,   T_STRING_LIT,
+    T_UNKNOWN,      T_UNTERMINATED_STRING_LIT, T_EOF,
+    T_STRING_LIT, // PACKED_ESCAPED
+};
+
+// a string with escapes in it, decoded when it is interned
+#define PACKED_ESCAPED 15u
+#define TOKEN_ESCAPED(packed)                                                  \
+    (((packed).kind_len & ((1u << PACKED_KIND_BITS) - 1)) == PACKED_ESCAPED)
+
+#define TOKEN_KIND(packed)                                                     \
+    (packed_kinds[(packed).kind_len & ((1u << PACKED_KIND_BITS) - 1)])
+#define TOKEN_LEN(packed) ((size_t)((packed).kind_len >> PACKED_KIND_BITS))
+
+// the index of `kind` in packed_kinds
+static token_word_t pack_kind(token_type_t kind) {
+    switch (kind) {
+    case T_LEFT_BRACKET:
+        return 1;
+    case T_RIGHT_BRACKET:
+        return 2;
+    case T_LEFT_CURLY:
+        return 3;
+    case T_RIGHT_CURLY:
+        return 4;
+    case T_COMMA:
+        return 5;
+    case T_COLON:
+        return 6;
+    case T_TRUE:
+        return 7;
+    case T_FALSE:
+        return 8;
+    case T_NULL:
+        return 9;
+    case T_NUMBER_LIT:
+        return 10;
+    case T_STRING_LIT:
+        return 11;
+    case T_UNKNOWN:
+        return 12;
+    case T_UNTERMINATED_STRING_LIT:
+        return 13;
+    case T_EOF:
+        return 14;
+    default:
+        return 0;
+    }
+}
+
+// the bytes of a packed string (without its quotes) or number
+static byte_slice token_bytes(u8 const *bytes, packed_token_t packed) {
+    byte_slice slice = SLICE((u8 *)bytes + packed.offset, TOKEN_LEN(packed));
+    if (TOKEN_KIND(packed) == T_STRING_LIT) {
+        slice.at += 1;
+        slice.len -= 2;
+    }
+    return slice;
+}
+
+static bool parse_token(struct parser *parser, token_t t);
+
+// The token spans [begin_i, position) of the input. Only a token going to a
+// sink needs its bytes in `t`, the token array keeps just the span.
 static bool push_token(lexer_t *lexer, token_t t) {
+    if (lexer->sink != NULL) {
+        return parse_token(lexer->sink, t);
+    }
     size_t at = lexer->next_token;
-    if (at + 1 <= lexer->max_tokens) {
-        lexer->tokens[at] = t;
+    size_t begin = t.kind == T_EOF ? lexer->position : lexer->begin_i;
+    size_t len = lexer->position - begin;
+    if (at + 1 <= lexer->max_tokens && len <= PACKED_MAX_LEN) {
+        lexer->tokens[at] = (packed_token_t){
+            .offset = (token_word_t)begin,
+            .kind_len = (token_word_t)(len << PACKED_KIND_BITS) |
+                        pack_kind(t.kind),
+        };
         lexer->next_token += 1;
-        lexer->line_info[at] = lexer->current_line;
         return true;
     }
     return false;
@@ -234,19 +630,237 @@ static bool push_token(lexer_t *lexer, token_t t) {
 
 #define MATCH_CONSUME_IDENT_CHAR(lexer) match_consume_ident_char(lexer, true)
 
-static bool match_consume_any_strchar(lexer_t *lexer) {
-    size_t pos;
-    if ((pos = lexer->position) >= lexer->len) {
-        return false;
+// Returns the position of the first '"', '\\' or control character at or
+// after `at`, `len` if there is none.
+static size_t scan_string_body(u8 const *bytes, size_t at, size_t len) {
+#if defined(AG_AVX2)
+    __m256i quote = _mm256_set1_epi8('"');
+    __m256i backslash = _mm256_set1_epi8('\\');
+    __m256i control = _mm256_set1_epi8(0x1F);
+
+    for (; at + 32 <= len; at += 32) {
+        __m256i v = _mm256_loadu_si256((__m256i const *)(bytes + at));
+        // v <= 0x1F (unsigned) iff max(v, 0x1F) == 0x1F
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                            _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+        u32 mask = (u32)_mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return at + ag_ctz64(mask);
+        }
     }
-    u8 c = lexer->bytes[pos];
-    if (c == '\\' || c == '"') {
-        return false;
+#endif
+#if defined(AG_SSE2)
+    __m128i quote_16 = _mm_set1_epi8('"');
+    __m128i backslash_16 = _mm_set1_epi8('\\');
+    __m128i control_16 = _mm_set1_epi8(0x1F);
+
+    for (; at + 16 <= len; at += 16) {
+        __m128i v = _mm_loadu_si128((__m128i const *)(bytes + at));
+        __m128i hits =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote_16),
+                                      _mm_cmpeq_epi8(v, backslash_16)),
+                         _mm_cmpeq_epi8(_mm_max_epu8(v, control_16), control_16));
+        u32 mask = (u32)_mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return at + ag_ctz64(mask);
+        }
     }
-    lexer->position += 1;
+#endif
+    for (; at < len; ++at) {
+        u8 c = bytes[at];
+        if (c == '"' || c == '\\' || c < 0x20) {
+            return at;
+        }
+    }
+    return len;
+}
+
+/*
+Escapes: the lexer checks them as it finds the end of a string, and marks
+the token; strings without any are interned straight from the input. The
+others are decoded when they are interned, into the pool where the interner
+would copy them (see intern_scratch). Decoding never grows a string: \uXXXX
+is at most 3 bytes of UTF-8, a surrogate pair (12 bytes) is 4. A surrogate
+that is not part of a pair is rejected, it has no UTF-8 encoding.
+*/
+
+// the value of 4 hex digits at `at`, -1 if one is not a hex digit
+static int hex4(u8 const *at) {
+    int value = 0;
+    for (int i = 0; i < 4; ++i) {
+        u8 c = at[i];
+        int digit = (c >= '0' && c <= '9')   ? c - '0'
+                    : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                    : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                                             : -1;
+        if (digit < 0) {
+            return -1;
+        }
+        value = value << 4 | digit;
+    }
+    return value;
+}
+
+// Where the escape starting with the backslash at `at` ends: `len` if the
+// input ends first, `at` if it is not a valid escape.
+static size_t escape_end(u8 const *bytes, size_t at, size_t len) {
+    if (at + 2 > len) {
+        return len;
+    }
+    switch (bytes[at + 1]) {
+    case '"':
+    case '\\':
+    case '/':
+    case 'b':
+    case 'f':
+    case 'n':
+    case 'r':
+    case 't':
+        return at + 2;
+    case 'u':
+        break;
+    default:
+        return at;
+    }
+
+    if (at + 6 > len) {
+        return len;
+    }
+    int unit = hex4(bytes + at + 2);
+    if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF)) {
+        return at;
+    }
+    if (unit < 0xD800 || unit > 0xDBFF) {
+        return at + 6;
+    }
+    // a high surrogate, the low one has to follow
+    if (at + 12 > len) {
+        return len;
+    }
+    if (bytes[at + 6] != '\\' || bytes[at + 7] != 'u') {
+        return at;
+    }
+    int low = hex4(bytes + at + 8);
+    return low >= 0xDC00 && low <= 0xDFFF ? at + 12 : at;
+}
+
+// The rest of a string from the backslash at *at: moves *at to its closing
+// quote (or the end of the input), or to an escape that is not valid and
+// returns false.
+static bool scan_escaped_body(u8 const *bytes, size_t *at, size_t len) {
+    size_t i = *at;
+    while (i < len && bytes[i] != '"') {
+        if (bytes[i] == '\\') {
+            size_t end = escape_end(bytes, i, len);
+            if (end == i) {
+                *at = i;
+                return false;
+            }
+            i = end;
+        } else {
+            i += 1; // a control character
+        }
+        i = scan_string_body(bytes, i, len);
+    }
+    *at = i;
     return true;
 }
 
+// Decodes the body of a string whose escapes were checked by the lexer into
+// `out` (at least as long as the body), returns the decoded length.
+static size_t unescape(u8 *out, byte_slice body) {
+    u8 const *in = body.at;
+    size_t n = 0;
+    size_t at = 0;
+    while (at < body.len) {
+        // runs without escapes are found (and copied) a vector at a time
+        size_t run = scan_string_body(in, at, body.len);
+        memcpy(out + n, in + at, run - at);
+        n += run - at;
+        at = run;
+        if (at >= body.len) {
+            break;
+        }
+        if (in[at] != '\\') {
+            out[n++] = in[at++]; // a control character, let through
+            continue;
+        }
+
+        u8 c = in[at + 1];
+        at += 2;
+        switch (c) {
+        case 'b':
+            out[n++] = '\b';
+            continue;
+        case 'f':
+            out[n++] = '\f';
+            continue;
+        case 'n':
+            out[n++] = '\n';
+            continue;
+        case 'r':
+            out[n++] = '\r';
+            continue;
+        case 't':
+            out[n++] = '\t';
+            continue;
+        case 'u':
+            break;
+        default: // '"', '\\' and '/' stand for themselves
+            out[n++] = c;
+            continue;
+        }
+
+        u32 code = (u32)hex4(in + at);
+        at += 4;
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            code = 0x10000 + ((code - 0xD800) << 10) +
+                   ((u32)hex4(in + at + 2) - 0xDC00);
+            at += 6;
+        }
+        if (code < 0x80) {
+            out[n++] = (u8)code;
+        } else if (code < 0x800) {
+            out[n++] = (u8)(0xC0 | code >> 6);
+            out[n++] = (u8)(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out[n++] = (u8)(0xE0 | code >> 12);
+            out[n++] = (u8)(0x80 | (code >> 6 & 0x3F));
+            out[n++] = (u8)(0x80 | (code & 0x3F));
+        } else {
+            out[n++] = (u8)(0xF0 | code >> 18);
+            out[n++] = (u8)(0x80 | (code >> 12 & 0x3F));
+            out[n++] = (u8)(0x80 | (code >> 6 & 0x3F));
+            out[n++] = (u8)(0x80 | (code & 0x3F));
+        }
+    }
+    return n;
+}
+
+// intern_string() for the body of a string with escapes, decoded
+static byte_slice intern_escaped(interner_t *interner, byte_slice body) {
+    if (interner->shards != NULL) {
+        // the shard depends on the decoded bytes, decode them aside first
+        // (never longer than `body`), on the stack unless the string is long
+        u8 small[256];
+        u8 *decoded = small;
+        if (body.len > sizeof(small) &&
+            !interner->allocator.alloc(body.len, &decoded)) {
+            panic("out of space while decoding a string");
+        }
+        byte_slice interned =
+            intern_string(interner, SLICE(decoded, unescape(decoded, body)));
+        if (decoded != small) {
+            interner->allocator.free(decoded);
+        }
+        return interned;
+    }
+    u8 *scratch = intern_scratch(interner, body.len);
+    return intern_in_place(interner, scratch, unescape(scratch, body));
+}
+
 static bool match_consume_ident_char(lexer_t *lexer, bool with_underscore) {
     size_t pos = lexer->position;
     if (pos >= lexer->len) {
@@ -338,125 +952,223 @@ static enum agnes_res_kind match_exponent(lexer_t *lexer) {
     return RES_LEXER_NONE;
 }
 
+/*
+Only byte offsets are tracked while lexing. Lines and columns are counted from
+the bytes when a result needs them, which is only on errors.
+*/
+
+// newlines in bytes[0, size)
+static size_t count_newlines(u8 const *bytes, size_t size) {
+    size_t count = 0;
+    size_t at = 0;
+#if defined(AG_AVX2)
+    for (; at + 32 <= size; at += 32) {
+        __m256i v = _mm256_loadu_si256((__m256i const *)(bytes + at));
+        __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        count += ag_popcount64((u32)_mm256_movemask_epi8(nl));
+    }
+#elif defined(AG_SSE2)
+    for (; at + 16 <= size; at += 16) {
+        __m128i v = _mm_loadu_si128((__m128i const *)(bytes + at));
+        __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        count += ag_popcount64((u32)_mm_movemask_epi8(nl));
+    }
+#endif
+    for (; at < size; ++at) {
+        count += bytes[at] == '\n';
+    }
+    return count;
+}
+
+// Moves `line` and `column` from those of bytes[0] to those of bytes[at].
+static void locate(u8 const *bytes, size_t at, size_t *line, size_t *column) {
+    size_t newlines = count_newlines(bytes, at);
+    if (newlines == 0) {
+        *column += at;
+        return;
+    }
+    size_t line_start = at;
+    while (bytes[line_start - 1] != '\n') {
+        --line_start;
+    }
+    *line += newlines;
+    *column = at - line_start + 1;
+}
+
+static agnes_result_t lexer_error(lexer_t const *lexer,
+                                  enum agnes_res_kind kind) {
+    agnes_result_t res = {.kind = kind,
+                          .byte_pos = lexer->begin_i,
+                          .line = lexer->first_line,
+                          .column = lexer->first_column};
+    locate(lexer->bytes, lexer->begin_i, &res.line, &res.column);
+    return res;
+}
+
 static agnes_result_t token_error(lexer_t *lexer, token_type_t token_kind) {
     size_t len = lexer->position - lexer->begin_i;
-    token_t t = {.kind = token_kind,
-                 .byte_sequence =
-                     INTERN(SLICE(lexer->bytes + lexer->begin_i, len))};
-
-    return (agnes_result_t){RES_LEXER_ERROR, lexer->begin_i,
-                            lexer->current_line, t};
+    agnes_result_t res = lexer_error(lexer, RES_LEXER_ERROR);
+    res.fragment = (token_t){
+        .kind = token_kind,
+        .byte_sequence = LEX_INTERN(SLICE(lexer->bytes + lexer->begin_i, len)),
+    };
+    return res;
 }
 
-static agnes_result_t tokenize(lexer_t *lexer) {
-    u8 c;
-    size_t next_token = 0;
-    size_t line_number = 1;
+#define LEXER_CONTINUE ((agnes_result_t){RES_LEXER_SOME})
+#define LEXER_END ((agnes_result_t){RES_LEXER_NONE})
+#define LEXER_PARTIAL ((agnes_result_t){RES_LEXER_PARTIAL})
 
-    while (lexer->position < lexer->len) {
-        // dbg("pos: %d", lexer->position);
-        c = consume(lexer);
-        lexer->begin_i = lexer->position - 1;
+// Streaming only: a run of non-separator bytes (number, literal, garbage)
+// reaching the end of the chunk may continue in the next one.
+static bool run_complete(lexer_t *lexer, size_t at) {
+    for (; at < lexer->len; ++at) {
+        if (char_class[lexer->bytes[at]] != CC_OTHER) {
+            return true;
+        }
+    }
+    return false;
+}
 
-        switch (c) {
-        case '-':
-            if (lexer->len > lexer->position) {
-                if (MATCH_CONSUME_NONZERO(lexer)) {
-                    goto lex_one_to_nine;
-                } else if (MATCH_CONSUME_ZERO(lexer)) {
-                    goto lex_zero;
-                }
+// Lexes the token starting with `c` (already consumed).
+// Returns LEXER_CONTINUE after pushing a token, LEXER_END on a '\0' byte and
+// an error result otherwise. Whitespace is handled by the callers.
+static agnes_result_t lex_token(lexer_t *lexer, u8 c) {
+    if (lexer->partial && char_class[c] == CC_OTHER &&
+        !run_complete(lexer, lexer->begin_i)) {
+        lexer->position = lexer->begin_i;
+        return LEXER_PARTIAL;
+    }
+
+    switch (c) {
+    case '-':
+        if (lexer->len > lexer->position) {
+            if (MATCH_CONSUME_NONZERO(lexer)) {
+                goto lex_one_to_nine;
+            } else if (MATCH_CONSUME_ZERO(lexer)) {
+                goto lex_zero;
             }
-            return token_error(lexer, T_NUMBER_LIT);
+        }
+        return token_error(lexer, T_NUMBER_LIT);
 
-        case '\0':
-            goto clean_return;
+    case '\0':
+        return LEXER_END;
 
-        case '\n':
-            lexer->current_line++;
-            break;
-        case ' ':
-        case '\r':
-        case '\t':
-            // ignore whitespace
-            break;
+    case 't':
+    case 'f':
+    case 'n': {
+        token_type_t expected_type =
+            c == 't' ? T_TRUE : (c == 'f' ? T_FALSE : T_NULL);
+        char const *literal =
+            c == 't' ? "true" : (c == 'f' ? "false" : "null");
 
-        case 't':
-        case 'f':
-        case 'n': {
-            token_type_t expected_type =
-                c == 't' ? T_TRUE : (c == 'f' ? T_FALSE : T_NULL);
+        while (MATCH_CONSUME_IDENT_CHAR(lexer)) {
+        }
+        size_t len = lexer->position - lexer->begin_i;
 
+        if (len == strlen(literal) &&
+            memcmp(lexer->bytes + lexer->begin_i, literal, len) == 0) {
             byte_slice expect =
-                expected_type == T_TRUE
-                    ? STR("true")
-                    : (expected_type == T_FALSE ? STR("false") : STR("null"));
-
-            while (MATCH_CONSUME_IDENT_CHAR(lexer)) {
+                LEX_VALUE(SLICE((u8 *)literal, strlen(literal)));
+            if (!push_token(lexer,
+                            (token_t){expected_type, .byte_sequence = expect})) {
+                return LEXER_OUT_OF_SPACE;
             }
-            size_t len = lexer->position - lexer->begin_i;
-            byte_slice string =
-                INTERN(SLICE(lexer->bytes + lexer->begin_i, len));
+        } else {
+            return token_error(lexer, T_UNKNOWN);
+        }
+    } break;
 
-            if (str_eq(string, expect)) {
-                if (!push_token(lexer, (token_t){expected_type,
-                                                 .byte_sequence = expect})) {
-                    return LEXER_OUT_OF_SPACE;
-                }
-            } else {
-                return token_error(lexer, T_UNKNOWN);
-            }
-        } break;
+    case '"': {
+        size_t at = lexer->position;
+        while ((at = scan_string_body(lexer->bytes, at, lexer->len)) <
+                   lexer->len &&
+               lexer->bytes[at] < 0x20) {
+            // unescaped control characters are accepted, as before
+            at += 1;
+        }
+        bool escaped = at < lexer->len && lexer->bytes[at] == '\\';
+        if (escaped && !scan_escaped_body(lexer->bytes, &at, lexer->len)) {
+            lexer->position = at + 2 < lexer->len ? at + 2 : lexer->len;
+            return token_error(lexer, T_STRING_LIT);
+        }
+        lexer->position = at;
+        u8 last = consume(lexer);
 
-        case '"': {
-            while (match_consume_any_strchar(lexer)) {
-            };
-            u8 last = consume(lexer);
+        if (last == '\0' && lexer->partial) {
+            lexer->position = lexer->begin_i;
+            return LEXER_PARTIAL;
+        }
+        if (last == '\0') {
+            return token_error(lexer, T_UNTERMINATED_STRING_LIT);
+        }
+
+        size_t start = lexer->begin_i + 1;
+        byte_slice slice =
+            SLICE(lexer->bytes + start, lexer->position - 1 - start);
+        if (lexer->sink != NULL) {
+            slice = escaped ? intern_escaped(lexer->interner, slice)
+                            : LEX_INTERN(slice);
+        }
+        token_t t = (token_t){T_STRING_LIT, .byte_sequence = slice};
+        if (!push_token(lexer, t)) {
+            return LEXER_OUT_OF_SPACE;
+        }
+        if (escaped && lexer->sink == NULL) {
+            lexer->tokens[lexer->next_token - 1].kind_len |= PACKED_ESCAPED;
+        }
+    } break;
 
-            size_t start = lexer->begin_i + 1;
-            size_t len = lexer->position - start - 1;
-            byte_slice slice = INTERN(SLICE(lexer->bytes + start, len));
+        // number = integer fraction exponent
+        // integer = digit | nonzero digits
+        // digits = digit | digit digits
+        // digit = '0' | nonzero
+        // nonzero = '1' | '2' | ... | '9'
+        // fraction = epsilon | '.' digits
+        // exponent = epsilon | ('E' | 'e') sign digits
+        // sign = epsilon | '-' | '+'
+    case '0': {
+    lex_zero:
+        if (MATCH_CONSUME_ANY_DIGIT(lexer)) {
+            return token_error(lexer, T_NUMBER_LIT);
+        }
+        if (match_fraction(lexer) == RES_LEXER_ERROR) {
+            return token_error(lexer, T_NUMBER_LIT);
+        }
+        if (match_exponent(lexer) == RES_LEXER_ERROR) {
+            return token_error(lexer, T_NUMBER_LIT);
+        }
 
-            switch (last) {
-            case '"':
-                token_t t = (token_t){T_STRING_LIT, .byte_sequence = slice};
-                if (!push_token(lexer, t)) {
-                    return LEXER_OUT_OF_SPACE;
-                }
-                break;
-            case '\\':
-                todo("escape sequences, et cetera.");
-                break;
-            case '\0':
-                return token_error(lexer, T_UNTERMINATED_STRING_LIT);
-            default:
-                panic("unreachable code path");
-            }
-        } break;
-
-            // number = integer fraction exponent
-            // integer = digit | nonzero digits
-            // digits = digit | digit digits
-            // digit = '0' | nonzero
-            // nonzero = '1' | '2' | ... | '9'
-            // fraction = epsilon | '.' digits
-            // exponent = epsilon | ('E' | 'e') sign digits
-            // sign = epsilon | '-' | '+'
-        case '0': {
-        lex_zero:
-            if (MATCH_CONSUME_ANY_DIGIT(lexer)) {
-                return token_error(lexer, T_NUMBER_LIT);
+        // left in the input, the parser converts (or interns) it
+        size_t len = lexer->position - lexer->begin_i;
+        byte_slice slice = SLICE((u8 *)lexer->bytes + lexer->begin_i, len);
+        token_t t = {
+            .kind = T_NUMBER_LIT,
+            .byte_sequence = slice,
+        };
+        if (!push_token(lexer, t)) {
+            return LEXER_OUT_OF_SPACE;
+        }
+        break;
+    }
+
+    default: {
+        token_type_t type;
+        if (c >= '1' && c <= '9') {
+        lex_one_to_nine:
+            while (MATCH_CONSUME_ANY_DIGIT(lexer)) {
             }
+
             if (match_fraction(lexer) == RES_LEXER_ERROR) {
                 return token_error(lexer, T_NUMBER_LIT);
             }
+
             if (match_exponent(lexer) == RES_LEXER_ERROR) {
                 return token_error(lexer, T_NUMBER_LIT);
             }
-
             size_t len = lexer->position - lexer->begin_i;
-            byte_slice slice =
-                INTERN(SLICE(lexer->bytes + lexer->begin_i, len));
+            byte_slice slice = SLICE((u8 *)lexer->bytes + lexer->begin_i, len);
+
             token_t t = {
                 .kind = T_NUMBER_LIT,
                 .byte_sequence = slice,
@@ -464,50 +1176,24 @@ static agnes_result_t tokenize(lexer_t *lexer) {
             if (!push_token(lexer, t)) {
                 return LEXER_OUT_OF_SPACE;
             }
-            break;
-        }
-
-        default: {
-            token_type_t type;
-            if (c >= '1' && c <= '9') {
-            lex_one_to_nine:
-                while (MATCH_CONSUME_ANY_DIGIT(lexer)) {
-                }
-
-                if (match_fraction(lexer) == RES_LEXER_ERROR) {
-                    return token_error(lexer, T_NUMBER_LIT);
-                }
-
-                if (match_exponent(lexer) == RES_LEXER_ERROR) {
-                    return token_error(lexer, T_NUMBER_LIT);
-                }
-                size_t len = lexer->position - lexer->begin_i;
-                byte_slice slice =
-                    INTERN(SLICE(lexer->bytes + lexer->begin_i, len));
 
-                token_t t = {
-                    .kind = T_NUMBER_LIT,
-                    .byte_sequence = slice,
-                };
-                if (!push_token(lexer, t)) {
-                    return LEXER_OUT_OF_SPACE;
-                }
-
-            } else if (((type = map_char[c]) & T_SIMPLE) == T_SIMPLE) {
-                token_t t = (token_t){type, c};
-                if (!push_token(lexer, t)) {
-                    return LEXER_OUT_OF_SPACE;
-                }
-            } else {
-                while (MATCH_CONSUME_IDENT_CHAR(lexer)) {
-                }
-
-                return token_error(lexer, T_UNKNOWN);
+        } else if (((type = map_char[c]) & T_SIMPLE) == T_SIMPLE) {
+            token_t t = (token_t){type, c};
+            if (!push_token(lexer, t)) {
+                return LEXER_OUT_OF_SPACE;
             }
-        } break;
+        } else {
+            while (MATCH_CONSUME_IDENT_CHAR(lexer)) {
+            }
+
+            return token_error(lexer, T_UNKNOWN);
         }
+    } break;
     }
-clean_return:
+    return LEXER_CONTINUE;
+}
+
+static agnes_result_t push_eof(lexer_t *lexer) {
     if (!push_token(lexer, (token_t){.kind = T_EOF})) {
         return LEXER_OUT_OF_SPACE;
     }
@@ -516,122 +1202,1949 @@ clean_return:
     };
 }
 
-static token_t peek_token(parser_t *parser) {
-    assert(parser->tokens[parser->len - 1].kind == T_EOF);
-
-    size_t pos = parser->position;
-    if (pos >= parser->len) {
-        return parser->tokens[parser->len - 1];
+// end of the bytes handed to the lexer, which is the end of the input unless
+// streaming
+static agnes_result_t end_of_bytes(lexer_t *lexer) {
+    if (lexer->partial) {
+        return LEXER_END;
     }
-    return parser->tokens[pos];
+    return push_eof(lexer);
 }
 
-static bool consume_token(parser_t *parser, token_type_t expect) {
-    assert(parser->tokens[parser->len - 1].kind == T_EOF);
+/*
+Structural stage: the input is classified 64 bytes at a time into bitmasks.
+Bit i of `starts` is set when byte i can begin a token, i.e. it is one of
+[]{}:," or the first byte of a run of other non-whitespace bytes. The lexer
+jumps from set bit to set bit instead of switching on every byte.
+
+No quote parity is tracked. A string (or any other token) is lexed in full
+once its first byte is reached, and all bits below the lexer's position are
+skipped afterwards, so bits inside strings never reach lex_token().
+Whitespace between tokens is never looked at byte by byte.
+*/
+
+#define BLOCK_SIZE 64
+
+#if defined(AG_AVX2)
+#define EQ_32(v, c) _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))
+#define MASK_32(v) ((u64)(u32)_mm256_movemask_epi8(v))
+
+static inline void classify_32(u8 const *at, u64 shift, u64 *op, u64 *quote,
+                               u64 *ws) {
+    __m256i v = _mm256_loadu_si256((__m256i const *)at);
+    // '[' and ']' differ from '{' and '}' only in bit 5
+    __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+    __m256i ops = _mm256_or_si256(
+        _mm256_or_si256(EQ_32(folded, '{'), EQ_32(folded, '}')),
+        _mm256_or_si256(EQ_32(v, ':'), EQ_32(v, ',')));
+    __m256i spaces =
+        _mm256_or_si256(_mm256_or_si256(EQ_32(v, ' '), EQ_32(v, '\t')),
+                        _mm256_or_si256(EQ_32(v, '\r'), EQ_32(v, '\n')));
+
+    *op |= MASK_32(ops) << shift;
+    *quote |= MASK_32(EQ_32(v, '"')) << shift;
+    *ws |= MASK_32(spaces) << shift;
+}
+#elif defined(AG_SSE2)
+#define EQ_16(v, c) _mm_cmpeq_epi8(v, _mm_set1_epi8(c))
+#define MASK_16(v) ((u64)(u32)_mm_movemask_epi8(v))
+
+static inline void classify_16(u8 const *at, u64 shift, u64 *op, u64 *quote,
+                               u64 *ws) {
+    __m128i v = _mm_loadu_si128((__m128i const *)at);
+    // '[' and ']' differ from '{' and '}' only in bit 5
+    __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+    __m128i ops = _mm_or_si128(_mm_or_si128(EQ_16(folded, '{'), EQ_16(folded, '}')),
+                               _mm_or_si128(EQ_16(v, ':'), EQ_16(v, ',')));
+    __m128i spaces = _mm_or_si128(_mm_or_si128(EQ_16(v, ' '), EQ_16(v, '\t')),
+                                  _mm_or_si128(EQ_16(v, '\r'), EQ_16(v, '\n')));
+
+    *op |= MASK_16(ops) << shift;
+    *quote |= MASK_16(EQ_16(v, '"')) << shift;
+    *ws |= MASK_16(spaces) << shift;
+}
+#endif
 
-    size_t pos = parser->position;
-    if (pos >= parser->len) {
-        return false;
+// The bits of bytes that can begin a token. `block` must have BLOCK_SIZE
+// readable bytes. The byte before the block is always treated as a
+// separator, see tokenize().
+static u64 classify_block(u8 const *block) {
+    u64 op = 0, quote = 0, ws = 0;
+
+#if defined(AG_AVX2)
+    classify_32(block, 0, &op, &quote, &ws);
+    classify_32(block + 32, 32, &op, &quote, &ws);
+#elif defined(AG_SSE2)
+    for (u64 i = 0; i < BLOCK_SIZE; i += 16) {
+        classify_16(block + i, i, &op, &quote, &ws);
     }
-    if (parser->tokens[pos].kind == expect) {
-        parser->position += 1;
-        return true;
+#else
+    for (u64 i = 0; i < BLOCK_SIZE; ++i) {
+        u8 class = char_class[block[i]];
+        op |= (u64)((class & CC_OP) != 0) << i;
+        quote |= (u64)((class & CC_QUOTE) != 0) << i;
+        ws |= (u64)((class & CC_WS) != 0) << i;
     }
-    return false;
+#endif
+
+    u64 separators = op | quote | ws;
+    u64 after_separator = (separators << 1) | 1u;
+
+    return op | quote | (~separators & after_separator);
 }
 
-static void advance(parser_t *parser) { parser->position++; }
+static agnes_result_t tokenize(lexer_t *lexer) {
+    u8 const *bytes = lexer->bytes;
+    size_t len = lexer->len;
+    size_t stop = lexer->stop != 0 ? lexer->stop : len;
+    size_t base = lexer->position;
 
-static jvalue_kind_t parse_value(parser_t *parser) {
-    assert(parser->tokens[parser->len - 1].kind == T_EOF);
-    token_t token = peek_token(parser);
-    // dbg("token: %s", format_token(token));
+    while (base < stop) {
+        size_t block_end = base + BLOCK_SIZE;
+        u64 starts;
 
-    switch (token.kind) {
-    // obj
-    case T_LEFT_CURLY: {
-        advance(parser);
-        bool last_is_pair = false;
-        bool consumed_pair = false;
-        while (consume_token(parser, T_STRING_LIT)) {
-            if (!consume_token(parser, T_COLON)) {
-                return J_ERROR; // for now just exit function completely,
-                                // later do better error handling
+        if (len - base >= BLOCK_SIZE) {
+            starts = classify_block(bytes + base);
+        } else {
+            u8 padded[BLOCK_SIZE];
+            memset(padded, ' ', BLOCK_SIZE);
+            memcpy(padded, bytes + base, len - base);
+            starts = classify_block(padded);
+        }
+
+        while (starts != 0) {
+            size_t at = base + ag_ctz64(starts);
+            starts &= starts - 1;
+
+            if (at < lexer->position) {
+                continue; // inside a token lexed earlier
             }
-            jvalue_kind_t val = parse_value(parser);
-            if (val == J_ERROR || val == J_NONE) {
-                return J_ERROR;
+            if (at >= stop) {
+                break; // the next chunk's
             }
 
-            consumed_pair = true;
-            last_is_pair = true;
-            if (!consume_token(parser, T_COMMA)) {
+            lexer->position = at;
+
+            // A token may stop short of the end of its run of non-separator
+            // bytes (e.g. "1.2.3"), the rest is lexed right away as the
+            // byte-at-a-time lexer would do.
+            do {
+                lexer->begin_i = lexer->position;
+                agnes_result_t res = lex_token(lexer, consume(lexer));
+                if (res.kind == RES_LEXER_NONE) {
+                    return push_eof(lexer);
+                } else if (res.kind != RES_LEXER_SOME) {
+                    return res;
+                }
+            } while (lexer->position < len &&
+                     char_class[bytes[lexer->position]] == CC_OTHER);
+
+            if (lexer->position >= block_end) {
                 break;
             }
-            last_is_pair = false;
         }
-        if (last_is_pair || !consumed_pair) {
-            if (!consume_token(parser, T_RIGHT_CURLY)) {
-                return J_ERROR;
-            }
-            return J_OBJECT;
+
+        if (lexer->position < block_end) {
+            // the rest of the block is whitespace
+            base = block_end;
         } else {
-            return J_ERROR;
+            base = lexer->position;
         }
-    } break;
+    }
+    if (lexer->stop != 0) {
+        return LEXER_END;
+    }
+    return end_of_bytes(lexer);
+}
 
-    // array
-    case T_LEFT_BRACKET: {
-        advance(parser);
-        bool last_is_val = false;
-        bool consumed_val = false;
-        while (parse_value(parser) != J_NONE) {
-            consumed_val = true;
-            last_is_val = true;
-            if (!consume_token(parser, T_COMMA)) {
-                break;
+/*
+UTF-8 validation (agnes_parser_t.validate_utf8), a pass over the whole input
+before it is lexed: bytes outside strings are ASCII in valid JSON, so this
+validates the strings. With AVX2, 32 bytes are checked at a time with three
+16-entry table lookups on the high and low nibbles of each byte and the one
+before it, which flag every error class of a 2-byte window at once (Keiser
+and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"); 3-
+and 4-byte sequences are checked by comparing with the bytes 2 and 3 back.
+All-ASCII blocks only carry over an unfinished sequence from the block
+before. Otherwise ASCII is skipped 16 (or 8) bytes at a time and the rest is
+decoded a character at a time. Either way, the error is pinned to a byte by
+the scalar code: the first byte of a sequence that is overlong, a surrogate,
+past U+10FFFF or cut short, or a continuation byte without a lead.
+*/
+
+// the length of the valid sequence at `at` (a non-ASCII byte), 0 if there is
+// none
+static size_t utf8_sequence(u8 const *bytes, size_t at, size_t len) {
+    u8 c = bytes[at];
+    size_t n;
+    u8 low = 0x80, high = 0xBF; // the second byte's range
+    if (c >= 0xC2 && c <= 0xDF) {
+        n = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3;
+        low = c == 0xE0 ? 0xA0 : 0x80; // overlong
+        high = c == 0xED ? 0x9F : 0xBF; // surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4;
+        low = c == 0xF0 ? 0x90 : 0x80;  // overlong
+        high = c == 0xF4 ? 0x8F : 0xBF; // past U+10FFFF
+    } else {
+        return 0;
+    }
+    if (at + n > len || bytes[at + 1] < low || bytes[at + 1] > high) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; ++i) {
+        if ((bytes[at + i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+// the first invalid byte at or after `at` (a character boundary), `len` if
+// there is none
+static size_t utf8_error_scalar(u8 const *bytes, size_t at, size_t len) {
+    while (at < len) {
+        if (bytes[at] >= 0x80) {
+            size_t n = utf8_sequence(bytes, at, len);
+            if (n == 0) {
+                return at;
             }
-            last_is_val = false;
+            at += n;
+            continue;
         }
-        if (last_is_val || !consumed_val) {
-            if (!consume_token(parser, T_RIGHT_BRACKET)) {
-                return J_ERROR;
+        // skip ASCII a block at a time, but only once inside a run of it
+#if defined(AG_SSE2)
+        if (at + 16 <= len &&
+            _mm_movemask_epi8(
+                _mm_loadu_si128((__m128i const *)(bytes + at))) == 0) {
+            at += 16;
+            continue;
+        }
+#else
+        if (at + 8 <= len) {
+            u64 word;
+            memcpy(&word, bytes + at, 8);
+            if ((word & 0x8080808080808080ull) == 0) {
+                at += 8;
+                continue;
             }
-            return J_ARRAY;
-        } else {
-            return J_ERROR;
         }
-    } break;
+#endif
+        at += 1;
+    }
+    return len;
+}
+
+#if defined(AG_AVX2)
+// error classes of a byte and the one before it, see Keiser and Lemire
+#define U8_TOO_SHORT (1 << 0) // a lead byte followed by another or ASCII
+#define U8_TOO_LONG (1 << 1)  // ASCII followed by a continuation byte
+#define U8_OVERLONG_3 (1 << 2)
+#define U8_TOO_LARGE (1 << 3)
+#define U8_SURROGATE (1 << 4)
+#define U8_OVERLONG_2 (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4 (1 << 6)
+#define U8_TWO_CONTS (1 << 7) // two continuation bytes, checked apart
+#define U8_CARRY (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
+
+#define U8_TABLE(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// the block `n` bytes back: the end of `prev` and the start of `input`
+#define U8_PREV(input, prev, n)                                                \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21),    \
+                       16 - (n))
+
+static __m256i utf8_nibble_high(__m256i v) {
+    return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+// nonzero bytes where `input` (after `prev`) is not valid UTF-8
+static __m256i utf8_block_errors(__m256i input, __m256i prev) {
+    __m256i prev1 = U8_PREV(input, prev, 1);
+    __m256i byte_1_high = _mm256_shuffle_epi8(
+        U8_TABLE(U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+                 U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+                 U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+                 U8_TOO_SHORT | U8_OVERLONG_2, U8_TOO_SHORT,
+                 U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+                 U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 |
+                     U8_OVERLONG_4),
+        utf8_nibble_high(prev1));
+    __m256i byte_1_low = _mm256_shuffle_epi8(
+        U8_TABLE(U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4,
+                 U8_CARRY | U8_OVERLONG_2, U8_CARRY, U8_CARRY,
+                 U8_CARRY | U8_TOO_LARGE,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+                 U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+        _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+    __m256i byte_2_high = _mm256_shuffle_epi8(
+        U8_TABLE(U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+                 U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+                 U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 |
+                     U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+                 U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 |
+                     U8_TOO_LARGE,
+                 U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE |
+                     U8_TOO_LARGE,
+                 U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE |
+                     U8_TOO_LARGE,
+                 U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT),
+        utf8_nibble_high(input));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low),
+                                       byte_2_high);
+
+    // a byte 2 back from 0xE0 up, or 3 back from 0xF0 up, must be followed
+    // by two continuation bytes in a row (U8_TWO_CONTS), and only then
+    __m256i third = _mm256_subs_epu8(U8_PREV(input, prev, 2),
+                                     _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(U8_PREV(input, prev, 3),
+                                      _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_be_2_3 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                           _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_be_2_3, special);
+}
+
+// nonzero when the block ends inside a sequence
+static __m256i utf8_block_incomplete(__m256i input) {
+    __m256i max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xF0 - 1),
+        (char)(0xE0 - 1), (char)(0xC0 - 1));
+    return _mm256_subs_epu8(input, max);
+}
+#endif
+
+// the offset of the first byte that is not valid UTF-8, `len` if all are
+static size_t utf8_error_at(u8 const *bytes, size_t len) {
+#if defined(AG_AVX2)
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    for (size_t base = 0; base < len + 32; base += 32) {
+        __m256i input;
+        if (base + 32 <= len) {
+            input = _mm256_loadu_si256((__m256i const *)(bytes + base));
+        } else {
+            // the tail, then one block past the end for what it leaves
+            // unfinished
+            u8 padded[32] = {0};
+            if (base < len) {
+                memcpy(padded, bytes + base, len - base);
+            }
+            input = _mm256_loadu_si256((__m256i const *)padded);
+        }
+
+        __m256i errors;
+        if (_mm256_movemask_epi8(input) == 0) {
+            errors = incomplete;
+        } else {
+            errors = utf8_block_errors(input, prev);
+            incomplete = utf8_block_incomplete(input);
+        }
+        if (!_mm256_testz_si256(errors, errors)) {
+            // Everything before the block is valid, but for a sequence it
+            // leaves unfinished, which starts at most 3 bytes back.
+            size_t at = base < 3 ? 0 : base - 3;
+            while (at < base && at < len && (bytes[at] & 0xC0) == 0x80) {
+                ++at;
+            }
+            return utf8_error_scalar(bytes, at, len);
+        }
+        prev = input;
+        if (base >= len) {
+            break;
+        }
+    }
+    return len;
+#else
+    return utf8_error_scalar(bytes, 0, len);
+#endif
+}
+
+/*
+Parallel tokenizing (agnes_parser_t.threads): the input is cut into one chunk
+per thread, each cut right after a newline where there is one nearby, after
+any separator otherwise. All chunks are lexed at once, guessing that none
+begins inside a string. A raw newline cannot appear in a valid string, so the
+guess only fails on invalid input or on a cut without a newline nearby.
+
+The guess is checked afterwards, in order: the chunk before has to stop at or
+before the cut. When its last token runs past the cut (a string containing
+it), the chunk is lexed again from where that token ends.
+
+The first chunk lexes straight into `tokens`, the others into buffers of their
+own that are appended in order. Tokens only hold offsets into the input, so
+appending them is a copy. Only the first chunk has an interner (for error
+fragments), the fragments of the others are interned when they are reached.
+*/
+
+#define PARALLEL_MIN_CHUNK MiB(1)
+
+typedef struct lex_chunk {
+    lexer_t lexer;
+    size_t begin;
+    agnes_result_t res;
+    allocator_t allocator; // grows the chunk's own token buffers
+    bool failed;
+} lex_chunk_t;
+
+// grows `*items` to at least `needed` items of `item_size` bytes, doubling,
+// and keeps the first `keep` of them
+static bool grow_buffer(allocator_t allocator, size_t needed, size_t keep,
+                        size_t item_size, u8 **items, size_t *cap) {
+    if (needed <= *cap) {
+        return true;
+    }
+    size_t new_cap = *cap == 0 ? KiB(4) : *cap;
+    while (new_cap < needed) {
+        new_cap *= 2;
+    }
+
+    u8 *new_items;
+    if (!allocator.alloc(new_cap * item_size, &new_items)) {
+        return false;
+    }
+    if (*items != NULL) {
+        memcpy(new_items, *items, keep * item_size);
+        allocator.free(*items);
+    }
+    *items = new_items;
+    *cap = new_cap;
+    return true;
+}
+
+static bool grow_token_buffer(allocator_t allocator, size_t needed,
+                              size_t keep, packed_token_t **tokens,
+                              size_t *max_tokens) {
+    return grow_buffer(allocator, needed, keep, sizeof(packed_token_t),
+                       (u8 **)tokens, max_tokens);
+}
+
+static void lex_chunk(lex_chunk_t *chunk) {
+    lexer_t *lexer = &chunk->lexer;
+    for (;;) {
+        chunk->res = tokenize(lexer);
+        if (chunk->res.kind != RES_OUT_OF_SPACE ||
+            chunk->allocator.alloc == NULL) {
+            return;
+        }
+        // lex the token that did not fit again
+        lexer->position = lexer->begin_i;
+        if (!grow_token_buffer(chunk->allocator, lexer->max_tokens + 1,
+                               lexer->next_token, &lexer->tokens,
+                               &lexer->max_tokens)) {
+            chunk->failed = true;
+            return;
+        }
+    }
+}
+
+static AG_THREAD_PROC(lex_chunk_proc) {
+    lex_chunk((lex_chunk_t *)arg);
+    AG_THREAD_RETURN;
+}
+
+// where to cut the input, at or after `at`
+static size_t chunk_cut(u8 const *bytes, size_t at, size_t len) {
+    size_t window = len - at < KiB(64) ? len - at : KiB(64);
+    u8 const *newline = memchr(bytes + at, '\n', window);
+    if (newline != NULL) {
+        return (size_t)(newline - bytes) + 1;
+    }
+    for (; at < len; ++at) {
+        if (char_class[bytes[at]] & (CC_OP | CC_WS)) {
+            return at + 1;
+        }
+    }
+    return len;
+}
+
+static agnes_result_t tokenize_parallel(lexer_t *lexer, size_t threads,
+                                        allocator_t allocator) {
+    u8 const *bytes = lexer->bytes;
+    size_t len = lexer->len;
+    size_t count = len / PARALLEL_MIN_CHUNK < threads
+                       ? len / PARALLEL_MIN_CHUNK
+                       : threads;
+    if (count < 2) {
+        return tokenize(lexer);
+    }
+
+    lex_chunk_t *chunks;
+    if (!allocator.alloc(count * (sizeof(lex_chunk_t) + sizeof(ag_thread_t)),
+                         (u8 **)&chunks)) {
+        return LEXER_OUT_OF_SPACE;
+    }
+    ag_thread_t *handles = (ag_thread_t *)(chunks + count);
+
+    size_t used = 0;
+    for (size_t begin = lexer->position; begin < len; ++used) {
+        size_t target = (used + 1) * (len / count);
+        size_t stop = used + 1 == count ? len
+                                        : chunk_cut(bytes,
+                                                    target > begin ? target
+                                                                   : begin,
+                                                    len);
+        chunks[used] = (lex_chunk_t){
+            .lexer =
+                {
+                    .filename = lexer->filename,
+                    .bytes = bytes,
+                    .len = len,
+                    .position = begin,
+                    .begin_i = begin,
+                    .first_line = lexer->first_line,
+                    .first_column = lexer->first_column,
+                    .stop = stop,
+                },
+            .begin = begin,
+            .allocator = allocator,
+        };
+        begin = stop;
+    }
+    if (used < 2) {
+        allocator.free((u8 *)chunks);
+        return tokenize(lexer);
+    }
+
+    chunks[0].lexer = *lexer;
+    chunks[0].lexer.stop = chunks[1].begin;
+    chunks[0].allocator = (allocator_t){0}; // `tokens` is the caller's
+
+    for (size_t i = 1; i < used; ++i) {
+        lexer_t *l = &chunks[i].lexer;
+        chunks[i].failed =
+            !grow_token_buffer(allocator, (l->stop - l->position) / 8 + 1, 0,
+                               &l->tokens, &l->max_tokens);
+    }
+
+    size_t started = 1;
+    for (; started < used; ++started) {
+        if (chunks[started].failed ||
+            !ag_thread_start(&handles[started], lex_chunk_proc,
+                             &chunks[started])) {
+            break;
+        }
+    }
+    lex_chunk(&chunks[0]);
+    for (size_t i = 1; i < started; ++i) {
+        ag_thread_join(handles[i]);
+    }
+
+    lexer_t *out = &chunks[0].lexer;
+    agnes_result_t res = chunks[0].res;
+
+    for (size_t i = 1; i < used && res.kind == RES_LEXER_NONE; ++i) {
+        if (out->next_token > 0 &&
+            TOKEN_KIND(out->tokens[out->next_token - 1]) == T_EOF) {
+            break; // a '\0' byte ended the input early
+        }
+
+        lex_chunk_t *chunk = &chunks[i];
+        lexer_t *l = &chunk->lexer;
+        if (chunk->failed) {
+            res = LEXER_OUT_OF_SPACE;
+            break;
+        }
+        if (i >= started || out->position > chunk->begin) {
+            // not started, or started inside a string: lex it (again)
+            l->position = out->position > chunk->begin ? out->position
+                                                       : chunk->begin;
+            l->next_token = 0;
+            lex_chunk(chunk);
+            if (chunk->failed) {
+                res = LEXER_OUT_OF_SPACE;
+                break;
+            }
+        }
+
+        if (out->next_token + l->next_token > out->max_tokens) {
+            res = LEXER_OUT_OF_SPACE;
+            break;
+        }
+        memcpy(out->tokens + out->next_token, l->tokens,
+               l->next_token * sizeof(packed_token_t));
+        out->next_token += l->next_token;
+
+        res = chunk->res;
+        if (res.kind == RES_LEXER_ERROR) {
+            res.fragment.byte_sequence =
+                intern_string(out->interner, res.fragment.byte_sequence);
+        }
+        out->position = l->position;
+    }
+
+    if (res.kind == RES_LEXER_NONE &&
+        (out->next_token == 0 ||
+         TOKEN_KIND(out->tokens[out->next_token - 1]) != T_EOF)) {
+        res = push_eof(out);
+    }
+
+    lexer->next_token = out->next_token;
+    lexer->position = out->position;
+
+    for (size_t i = 1; i < used; ++i) {
+        if (chunks[i].lexer.tokens != NULL) {
+            allocator.free((u8 *)chunks[i].lexer.tokens);
+        }
+    }
+    allocator.free((u8 *)chunks);
+    return res;
+}
+
+// the token under the cursor, its bytes point into the input (not interned)
+static token_t peek_token(parser_t *parser) {
+    assert(TOKEN_KIND(parser->tokens[parser->len - 1]) == T_EOF);
+
+    size_t pos = parser->position;
+    packed_token_t packed = parser->tokens[pos < parser->len ? pos
+                                                             : parser->len - 1];
+    token_t t = {.kind = TOKEN_KIND(packed)};
+    if ((t.kind & T_SIMPLE) == 0 || t.kind == T_TRUE || t.kind == T_FALSE ||
+        t.kind == T_NULL) {
+        t.byte_sequence = token_bytes(parser->bytes, packed);
+    } else if (t.kind != T_EOF) {
+        t.simple_token = (char)parser->bytes[packed.offset];
+    }
+    return t;
+}
+
+static token_type_t peek_kind(parser_t *parser) {
+    size_t pos = parser->position;
+    return TOKEN_KIND(parser->tokens[pos < parser->len ? pos : parser->len - 1]);
+}
+
+static bool consume_token(parser_t *parser, token_type_t expect) {
+    assert(TOKEN_KIND(parser->tokens[parser->len - 1]) == T_EOF);
+
+    size_t pos = parser->position;
+    if (pos >= parser->len) {
+        return false;
+    }
+    if (TOKEN_KIND(parser->tokens[pos]) == expect) {
+        parser->position += 1;
+        return true;
+    }
+    return false;
+}
+
+static void advance(parser_t *parser) { parser->position++; }
+
+/*
+Numbers: converted when they reach the tape (or `raw_numbers` keeps their
+text and tape_number converts that later). Integers stay exact, as an i64 or
+as a u64 above INT64_MAX. Anything else becomes the nearest double: small
+mantissas and exponents multiply exactly (Clinger's fast path), the rest goes
+through Eisel-Lemire, and the few inputs it cannot settle (ties, subnormals,
+results past DBL_MAX) through strtod.
+Nothing is out of range: integers too large for 64 bits become doubles, too
+large magnitudes become infinity and too small ones zero, keeping the sign.
+*/
+#define NUMBER_MIN_POW10 (-342)
+#define NUMBER_MAX_POW10 308
+#define NUMBER_MAX_DIGITS 19 // kept in the mantissa, the rest only rounds
+
+static double const exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// 5^q for q in [NUMBER_MIN_POW10, NUMBER_MAX_POW10], as the 128 most
+// significant bits (high word first). Truncated, except for q < 0 where the
+// reciprocal is rounded up.
+static u64 const powers_of_five[] = {
+    0xeef453d6923bd65aull, 0x113faa2906a13b3full,
+    0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull,
+    0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull,
+    0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull,
+    0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull,
+    0xb64ec836a47146f9ull, 0x9748e2826cdee284ull,
+    0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull,
+    0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull,
+    0xb208ef855c969f4full, 0xbdbd2d335e51a935ull,
+    0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull,
+    0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull,
+    0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull,
+    0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull,
+    0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull,
+    0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull,
+    0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull,
+    0x84a57695fe98746dull, 0x014bb630f7604b57ull,
+    0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull,
+    0xcf42894a5dce35eaull, 0x52064cac828675b9ull,
+    0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull,
+    0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull,
+    0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull,
+    0xfd00b897478238d0ull, 0x8920b098955522b4ull,
+    0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull,
+    0xc5a890362fddbc62ull, 0xeb2189f734aa831dull,
+    0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull,
+    0x9a6bb0aa55653b2dull, 0x47b233c92125366eull,
+    0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull,
+    0xf148440a256e2c76ull, 0xc00670ea43ca250dull,
+    0x96cd2a865764dbcaull, 0x380406926a5e5728ull,
+    0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull,
+    0xeba09271e88d976bull, 0xf7864a44c633682eull,
+    0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull,
+    0xb8157268fdae9e4cull, 0x5960ea05bad82964ull,
+    0xe61acf033d1a45dfull, 0x6fb92487298e33bdull,
+    0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull,
+    0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull,
+    0xe0b62e2929aba83cull, 0x331acdabfe94de87ull,
+    0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull,
+    0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull,
+    0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull,
+    0x892731ac9faf056eull, 0xbe311c083a225cd2ull,
+    0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull,
+    0xd64d3d9db981787dull, 0x092cbbccdad5b108ull,
+    0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull,
+    0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull,
+    0xd1476e2c07286faaull, 0x1af5af660db4aee1ull,
+    0x82cca4db847945caull, 0x50d98d9fc890ed4dull,
+    0xa37fce126597973cull, 0xe50ff107bab528a0ull,
+    0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull,
+    0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull,
+    0x9faacf3df73609b1ull, 0x77b191618c54e9acull,
+    0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull,
+    0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull,
+    0x9becce62836ac577ull, 0x4ee367f9430aec32ull,
+    0xc2e801fb244576d5ull, 0x229c41f793cda73full,
+    0xf3a20279ed56d48aull, 0x6b43527578c1110full,
+    0x9845418c345644d6ull, 0x830a13896b78aaa9ull,
+    0xbe5691ef416bd60cull, 0x23cc986bc656d553ull,
+    0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull,
+    0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull,
+    0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull,
+    0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull,
+    0x91376c36d99995beull, 0x23100809b9c21fa1ull,
+    0xb58547448ffffb2dull, 0xabd40a0c2832a78aull,
+    0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull,
+    0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull,
+    0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull,
+    0xdd95317f31c7fa1dull, 0x40405643d711d583ull,
+    0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull,
+    0xad1c8eab5ee43b66ull, 0xda3243650005eecfull,
+    0xd863b256369d4a40ull, 0x90bed43e40076a82ull,
+    0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull,
+    0xa90de3535aaae202ull, 0x711515d0a205cb36ull,
+    0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull,
+    0x8412d9991ed58091ull, 0xe858790afe9486c2ull,
+    0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull,
+    0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full,
+    0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull,
+    0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull,
+    0xc987434744ac874eull, 0xa327ffb266b56220ull,
+    0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull,
+    0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull,
+    0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull,
+    0xf6019da07f549b2bull, 0x7e2a53a146606a48ull,
+    0x99c102844f94e0fbull, 0x2eda7444cbfc426dull,
+    0xc0314325637a1939ull, 0xfa911155fefb5308ull,
+    0xf03d93eebc589f88ull, 0x793555ab7eba27caull,
+    0x96267c7535b763b5ull, 0x4bc1558b2f3458deull,
+    0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull,
+    0xea9c227723ee8bcbull, 0x465e15a979c1cadcull,
+    0x92a1958a7675175full, 0x0bfacd89ec191ec9ull,
+    0xb749faed14125d36ull, 0xcef980ec671f667bull,
+    0xe51c79a85916f484ull, 0x82b7e12780e7401aull,
+    0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull,
+    0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull,
+    0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull,
+    0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull,
+    0xaecc49914078536dull, 0x58fae9f773886e18ull,
+    0xda7f5bf590966848ull, 0xaf39a475506a899eull,
+    0x888f99797a5e012dull, 0x6d8406c952429603ull,
+    0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull,
+    0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull,
+    0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full,
+    0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull,
+    0xd0601d8efc57b08bull, 0xf13b94daf124da26ull,
+    0x823c12795db6ce57ull, 0x76c53d08d6b70858ull,
+    0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull,
+    0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull,
+    0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull,
+    0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull,
+    0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull,
+    0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull,
+    0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull,
+    0xc21094364dfb5636ull, 0x985915fc12f542e4ull,
+    0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull,
+    0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull,
+    0xbd8430bd08277231ull, 0x50c6ff782a838353ull,
+    0xece53cec4a314ebdull, 0xa4f8bf5635246428ull,
+    0x940f4613ae5ed136ull, 0x871b7795e136be99ull,
+    0xb913179899f68584ull, 0x28e2557b59846e3full,
+    0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull,
+    0x9096ea6f3848984full, 0x3ff0d2c85def7621ull,
+    0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull,
+    0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull,
+    0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull,
+    0xb080392cc4349decull, 0xbd8d794d96aacfb3ull,
+    0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull,
+    0x89e42caaf9491b60ull, 0xf41686c49db57244ull,
+    0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull,
+    0xd77485cb25823ac7ull, 0x7d633293366b828bull,
+    0x86a8d39ef77164bcull, 0xae5dff9c02033197ull,
+    0xa8530886b54dbdebull, 0xd9f57f830283fdfcull,
+    0xd267caa862a12d66ull, 0xd072df63c324fd7bull,
+    0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull,
+    0xa46116538d0deb78ull, 0x52d9be85f074e608ull,
+    0xcd795be870516656ull, 0x67902e276c921f8bull,
+    0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull,
+    0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull,
+    0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull,
+    0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull,
+    0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull,
+    0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull,
+    0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull,
+    0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull,
+    0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull,
+    0xef340a98172aace4ull, 0x86fb897116c87c34ull,
+    0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull,
+    0xbae0a846d2195712ull, 0x8974836059cca109ull,
+    0xe998d258869facd7ull, 0x2bd1a438703fc94bull,
+    0x91ff83775423cc06ull, 0x7b6306a34627ddcfull,
+    0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull,
+    0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull,
+    0x8e938662882af53eull, 0x547eb47b7282ee9cull,
+    0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull,
+    0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull,
+    0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull,
+    0xae0b158b4738705eull, 0x9624ab50b148d445ull,
+    0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull,
+    0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull,
+    0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull,
+    0xd47487cc8470652bull, 0x7647c3200069671full,
+    0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull,
+    0xa5fb0a17c777cf09ull, 0xf468107100525890ull,
+    0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull,
+    0x81ac1fe293d599bfull, 0xc6f14cd848405530ull,
+    0xa21727db38cb002full, 0xb8ada00e5a506a7cull,
+    0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull,
+    0xfd442e4688bd304aull, 0x908f4a166d1da663ull,
+    0x9e4a9cec15763e2eull, 0x9a598e4e043287feull,
+    0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull,
+    0xf7549530e188c128ull, 0xd12bee59e68ef47cull,
+    0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull,
+    0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull,
+    0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull,
+    0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull,
+    0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull,
+    0xebdf661791d60f56ull, 0x111b495b3464ad21ull,
+    0x936b9fcebb25c995ull, 0xcab10dd900beec34ull,
+    0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull,
+    0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull,
+    0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull,
+    0xb3f4e093db73a093ull, 0x59ed216765690f56ull,
+    0xe0f218b8d25088b8ull, 0x306869c13ec3532cull,
+    0x8c974f7383725573ull, 0x1e414218c73a13fbull,
+    0xafbd2350644eeacfull, 0xe5d1929ef90898faull,
+    0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull,
+    0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull,
+    0xab9eb47c81f5114full, 0x066ea92f3f326564ull,
+    0xd686619ba27255a2ull, 0xc80a537b0efefebdull,
+    0x8613fd0145877585ull, 0xbd06742ce95f5f36ull,
+    0xa798fc4196e952e7ull, 0x2c48113823b73704ull,
+    0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull,
+    0x82ef85133de648c4ull, 0x9a984d73dbe722fbull,
+    0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull,
+    0xcc963fee10b7d1b3ull, 0x318df905079926a8ull,
+    0xffbbcfe994e5c61full, 0xfdf17746497f7052ull,
+    0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull,
+    0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull,
+    0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull,
+    0x9c1661a651213e2dull, 0x06bea10ca65c084eull,
+    0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull,
+    0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull,
+    0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull,
+    0xbe89523386091465ull, 0xf6bbb397f1135823ull,
+    0xee2ba6c0678b597full, 0x746aa07ded582e2cull,
+    0x94db483840b717efull, 0xa8c2a44eb4571cdcull,
+    0xba121a4650e4ddebull, 0x92f34d62616ce413ull,
+    0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull,
+    0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull,
+    0xb5b5ada8aaff80b8ull, 0x0d819992132456baull,
+    0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull,
+    0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull,
+    0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull,
+    0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull,
+    0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull,
+    0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull,
+    0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull,
+    0x87625f056c7c4a8bull, 0x11471cd764ad4972ull,
+    0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull,
+    0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull,
+    0x843610cb4bf160cbull, 0xcedf722a585139baull,
+    0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull,
+    0xce947a3da6a9273eull, 0x733d226229feea32ull,
+    0x811ccc668829b887ull, 0x0806357d5a3f525full,
+    0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull,
+    0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull,
+    0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull,
+    0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull,
+    0xc5029163f384a931ull, 0x0a9e795e65d4df11ull,
+    0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull,
+    0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull,
+    0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull,
+    0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull,
+    0x964e858c91ba2655ull, 0x3a6a07f8d510f86full,
+    0xbbe226efb628afeaull, 0x890489f70a55368bull,
+    0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull,
+    0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull,
+    0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull,
+    0xe55990879ddcaabdull, 0xcc420a6a101d0515ull,
+    0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull,
+    0xb32df8e9f3546564ull, 0x47939822dc96abf9ull,
+    0xdff9772470297ebdull, 0x59787e2b93bc56f7ull,
+    0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull,
+    0xaefae51477a06b03ull, 0xede622920b6b23f1ull,
+    0xdab99e59958885c4ull, 0xe95fab368e45ecedull,
+    0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull,
+    0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull,
+    0xd59944a37c0752a2ull, 0x4be76d3346f0495full,
+    0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull,
+    0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull,
+    0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull,
+    0x825ecc24c873782full, 0x8ed400668c0c28c8ull,
+    0xa2f67f2dfa90563bull, 0x728900802f0f32faull,
+    0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull,
+    0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull,
+    0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull,
+    0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull,
+    0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull,
+    0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull,
+    0xc24452da229b021bull, 0xfbe85badce996168ull,
+    0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull,
+    0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull,
+    0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull,
+    0xed246723473e3813ull, 0x290123e9aab23b68ull,
+    0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull,
+    0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull,
+    0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull,
+    0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull,
+    0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull,
+    0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull,
+    0x8d590723948a535full, 0x579c487e5a38ad0eull,
+    0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull,
+    0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull,
+    0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull,
+    0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full,
+    0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full,
+    0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull,
+    0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull,
+    0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull,
+    0x83a3eeeef9153e89ull, 0x1953cf68300424acull,
+    0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull,
+    0xcdb02555653131b6ull, 0x3792f412cb06794dull,
+    0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull,
+    0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull,
+    0xc8de047564d20a8bull, 0xf245825a5a445275ull,
+    0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull,
+    0x9ced737bb6c4183dull, 0x55464dd69685606bull,
+    0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull,
+    0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull,
+    0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull,
+    0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull,
+    0xef73d256a5c0f77cull, 0x963e66858f6d4440ull,
+    0x95a8637627989aadull, 0xdde7001379a44aa8ull,
+    0xbb127c53b17ec159ull, 0x5560c018580d5d52ull,
+    0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull,
+    0x9226712162ab070dull, 0xcab3961304ca70e8ull,
+    0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull,
+    0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull,
+    0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull,
+    0xb267ed1940f1c61cull, 0x55f038b237591ed3ull,
+    0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull,
+    0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull,
+    0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull,
+    0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull,
+    0x881cea14545c7575ull, 0x7e50d64177da2e54ull,
+    0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull,
+    0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull,
+    0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull,
+    0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull,
+    0xcfb11ead453994baull, 0x67de18eda5814af2ull,
+    0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull,
+    0xa2425ff75e14fc31ull, 0xa1258379a94d028dull,
+    0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull,
+    0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull,
+    0x9e74d1b791e07e48ull, 0x775ea264cf55347eull,
+    0xc612062576589ddaull, 0x95364afe032a819eull,
+    0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull,
+    0x9abe14cd44753b52ull, 0xc4926a9672793543ull,
+    0xc16d9a0095928a27ull, 0x75b7053c0f178294ull,
+    0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull,
+    0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull,
+    0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull,
+    0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull,
+    0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull,
+    0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull,
+    0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull,
+    0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull,
+    0xb424dc35095cd80full, 0x538484c19ef38c95ull,
+    0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull,
+    0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull,
+    0xafebff0bcb24aafeull, 0xf78f69a51539d749ull,
+    0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull,
+    0x89705f4136b4a597ull, 0x31680a88f8953031ull,
+    0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull,
+    0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull,
+    0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull,
+    0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull,
+    0xd1b71758e219652bull, 0xd3c36113404ea4a9ull,
+    0x83126e978d4fdf3bull, 0x645a1cac083126eaull,
+    0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull,
+    0xccccccccccccccccull, 0xcccccccccccccccdull,
+    0x8000000000000000ull, 0x0000000000000000ull,
+    0xa000000000000000ull, 0x0000000000000000ull,
+    0xc800000000000000ull, 0x0000000000000000ull,
+    0xfa00000000000000ull, 0x0000000000000000ull,
+    0x9c40000000000000ull, 0x0000000000000000ull,
+    0xc350000000000000ull, 0x0000000000000000ull,
+    0xf424000000000000ull, 0x0000000000000000ull,
+    0x9896800000000000ull, 0x0000000000000000ull,
+    0xbebc200000000000ull, 0x0000000000000000ull,
+    0xee6b280000000000ull, 0x0000000000000000ull,
+    0x9502f90000000000ull, 0x0000000000000000ull,
+    0xba43b74000000000ull, 0x0000000000000000ull,
+    0xe8d4a51000000000ull, 0x0000000000000000ull,
+    0x9184e72a00000000ull, 0x0000000000000000ull,
+    0xb5e620f480000000ull, 0x0000000000000000ull,
+    0xe35fa931a0000000ull, 0x0000000000000000ull,
+    0x8e1bc9bf04000000ull, 0x0000000000000000ull,
+    0xb1a2bc2ec5000000ull, 0x0000000000000000ull,
+    0xde0b6b3a76400000ull, 0x0000000000000000ull,
+    0x8ac7230489e80000ull, 0x0000000000000000ull,
+    0xad78ebc5ac620000ull, 0x0000000000000000ull,
+    0xd8d726b7177a8000ull, 0x0000000000000000ull,
+    0x878678326eac9000ull, 0x0000000000000000ull,
+    0xa968163f0a57b400ull, 0x0000000000000000ull,
+    0xd3c21bcecceda100ull, 0x0000000000000000ull,
+    0x84595161401484a0ull, 0x0000000000000000ull,
+    0xa56fa5b99019a5c8ull, 0x0000000000000000ull,
+    0xcecb8f27f4200f3aull, 0x0000000000000000ull,
+    0x813f3978f8940984ull, 0x4000000000000000ull,
+    0xa18f07d736b90be5ull, 0x5000000000000000ull,
+    0xc9f2c9cd04674edeull, 0xa400000000000000ull,
+    0xfc6f7c4045812296ull, 0x4d00000000000000ull,
+    0x9dc5ada82b70b59dull, 0xf020000000000000ull,
+    0xc5371912364ce305ull, 0x6c28000000000000ull,
+    0xf684df56c3e01bc6ull, 0xc732000000000000ull,
+    0x9a130b963a6c115cull, 0x3c7f400000000000ull,
+    0xc097ce7bc90715b3ull, 0x4b9f100000000000ull,
+    0xf0bdc21abb48db20ull, 0x1e86d40000000000ull,
+    0x96769950b50d88f4ull, 0x1314448000000000ull,
+    0xbc143fa4e250eb31ull, 0x17d955a000000000ull,
+    0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull,
+    0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull,
+    0xb7abc627050305adull, 0xf14a3d9e40000000ull,
+    0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull,
+    0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull,
+    0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull,
+    0xe0352f62a19e306eull, 0xd50b2037ad200000ull,
+    0x8c213d9da502de45ull, 0x4526f422cc340000ull,
+    0xaf298d050e4395d6ull, 0x9670b12b7f410000ull,
+    0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull,
+    0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull,
+    0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull,
+    0xd5d238a4abe98068ull, 0x72a4904598d6d880ull,
+    0x85a36366eb71f041ull, 0x47a6da2b7f864750ull,
+    0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull,
+    0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull,
+    0x82818f1281ed449full, 0xbff8f10e7a8921a4ull,
+    0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull,
+    0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull,
+    0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull,
+    0x9f4f2726179a2245ull, 0x01d762422c946590ull,
+    0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull,
+    0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull,
+    0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full,
+    0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull,
+    0xf316271c7fc3908aull, 0x8bef464e3945ef7aull,
+    0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull,
+    0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull,
+    0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull,
+    0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull,
+    0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull,
+    0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull,
+    0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull,
+    0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull,
+    0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull,
+    0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull,
+    0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull,
+    0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull,
+    0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull,
+    0xacb92ed9397bf996ull, 0x49c2c37f07965404ull,
+    0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull,
+    0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull,
+    0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull,
+    0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull,
+    0x83c7088e1aab65dbull, 0x792667c6da79e0faull,
+    0xa4b8cab1a1563f52ull, 0x577001b891185938ull,
+    0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull,
+    0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull,
+    0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull,
+    0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull,
+    0xfb5878494ace3a5full, 0x04ab48a04065c723ull,
+    0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull,
+    0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull,
+    0xf5746577930d6500ull, 0xca8f44ec7ee36479ull,
+    0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull,
+    0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull,
+    0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull,
+    0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull,
+    0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull,
+    0xea1575143cf97226ull, 0xf52d09d71a3293bdull,
+    0x924d692ca61be758ull, 0x593c2626705f9c56ull,
+    0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull,
+    0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull,
+    0x8edf98b59a373fecull, 0x4724bd4189bd5eacull,
+    0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull,
+    0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull,
+    0x8b865b215899f46cull, 0xbd79e0d20082ee74ull,
+    0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull,
+    0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull,
+    0x884134fe908658b2ull, 0x3109058d147fdcddull,
+    0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull,
+    0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull,
+    0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull,
+    0xa6539930bf6bff45ull, 0x84db8346b786151cull,
+    0xcfe87f7cef46ff16ull, 0xe612641865679a63ull,
+    0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull,
+    0xa26da3999aef7749ull, 0xe3be5e330f38f09dull,
+    0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull,
+    0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull,
+    0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull,
+    0xc646d63501a1511dull, 0xb281e1fd541501b8ull,
+    0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull,
+    0x9ae757596946075full, 0x3375788de9b06958ull,
+    0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull,
+    0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull,
+    0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull,
+    0xbd176620a501fbffull, 0xb650e5a93bc3d898ull,
+    0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull,
+    0x93ba47c980e98cdfull, 0xc66f336c36b10137ull,
+    0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull,
+    0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull,
+    0x9043ea1ac7e41392ull, 0x87c89837ad68db2full,
+    0xb454e4a179dd1877ull, 0x29babe4598c311fbull,
+    0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull,
+    0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull,
+    0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full,
+    0xdc21a1171d42645dull, 0x76707543f4fa1f73ull,
+    0x899504ae72497ebaull, 0x6a06494a791c53a8ull,
+    0xabfa45da0edbde69ull, 0x0487db9d17636892ull,
+    0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull,
+    0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull,
+    0xa7f26836f282b732ull, 0x8e6cac7768d7141eull,
+    0xd1ef0244af2364ffull, 0x3207d795430cd926ull,
+    0x8335616aed761f1full, 0x7f44e6bd49e807b8ull,
+    0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull,
+    0xcd036837130890a1ull, 0x36dba887c37a8c0full,
+    0x802221226be55a64ull, 0xc2494954da2c9789ull,
+    0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull,
+    0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull,
+    0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull,
+    0x9c69a97284b578d7ull, 0xff2a760414536efbull,
+    0xc38413cf25e2d70dull, 0xfef5138519684abaull,
+    0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull,
+    0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull,
+    0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull,
+    0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull,
+    0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull,
+    0xba756174393d88dfull, 0x94f971119aeef9e4ull,
+    0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull,
+    0x91abb422ccb812eeull, 0xac62e055c10ab33aull,
+    0xb616a12b7fe617aaull, 0x577b986b314d6009ull,
+    0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull,
+    0x8e41ade9fbebc27dull, 0x14588f13be847307ull,
+    0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull,
+    0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull,
+    0x8aec23d680043beeull, 0x25de7bb9480d5854ull,
+    0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull,
+    0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull,
+    0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull,
+    0xa99541bf57452b28ull, 0x353a1607ac744a53ull,
+    0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull,
+    0x847c9b5d7c2e09b7ull, 0x69956135febada11ull,
+    0xa59bc234db398c25ull, 0x43fab9837e699095ull,
+    0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull,
+    0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull,
+    0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull,
+    0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull,
+    0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull,
+    0x9defbf01b061adabull, 0x3a0888136afa64a7ull,
+    0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull,
+    0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull,
+    0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull,
+    0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull,
+    0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull,
+    0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull,
+    0xbc4665b596706114ull, 0x873d5d9f0dde1feeull,
+    0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull,
+    0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull,
+    0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full,
+    0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull,
+    0x8fa475791a569d10ull, 0xf96e017d694487bcull,
+    0xb38d92d760ec4455ull, 0x37c981dcc395a9acull,
+    0xe070f78d3927556aull, 0x85bbe253f47b1417ull,
+    0x8c469ab843b89562ull, 0x93956d7478ccec8eull,
+    0xaf58416654a6babbull, 0x387ac8d1970027b2ull,
+    0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull,
+    0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull,
+    0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull,
+    0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull,
+    0x85c7056562757456ull, 0xf6872d5667844e49ull,
+    0xa738c6bebb12d16cull, 0xb428f8ac016561dbull,
+    0xd106f86e69d785c7ull, 0xe13336d701beba52ull,
+    0x82a45b450226b39cull, 0xecc0024661173473ull,
+    0xa34d721642b06084ull, 0x27f002d7f95d0190ull,
+    0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull,
+    0xff290242c83396ceull, 0x7e67047175a15271ull,
+    0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull,
+    0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull,
+    0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull,
+    0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull,
+    0xc2abf989935ddbfeull, 0x6acff893d00ea435ull,
+    0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull,
+    0x98165af37b2153deull, 0xc3727a337a8b704aull,
+    0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull,
+    0xeda2ee1c7064130cull, 0x1162def06f79df73ull,
+    0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull,
+    0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull,
+    0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull,
+    0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull,
+    0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull,
+    0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull,
+    0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull,
+    0xb10d8e1456105dadull, 0x7425a83e872c5f47ull,
+    0xdd50f1996b947518ull, 0xd12f124e28f77719ull,
+    0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full,
+    0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull,
+    0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull,
+    0x8714a775e3e95c78ull, 0x65acfaec34810a71ull,
+    0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull,
+    0xd31045a8341ca07cull, 0x1ede48111209a050ull,
+    0x83ea2b892091e44dull, 0x934aed0aab460432ull,
+    0xa4e4b66b68b65d60ull, 0xf81da84d5617853full,
+    0xce1de40642e3f4b9ull, 0x36251260ab9d668eull,
+    0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull,
+    0xa1075a24e4421730ull, 0xb24cf65b8612f81full,
+    0xc94930ae1d529cfcull, 0xdee033f26797b627ull,
+    0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull,
+    0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull,
+    0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull,
+    0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull,
+    0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull,
+    0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull,
+    0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull,
+    0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull,
+    0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull,
+    0xea53df5fd18d5513ull, 0x84c86189216dc5edull,
+    0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull,
+    0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull,
+    0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull,
+    0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull,
+    0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull,
+    0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull,
+    0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull,
+    0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull,
+    0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull,
+    0x8865899617fb1871ull, 0x7e2fa67c7a658892ull,
+    0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull,
+    0xd51ea6fa85785631ull, 0x552a74227f3ea565ull,
+    0x8533285c936b35deull, 0xd53a88958f87275full,
+    0xa67ff273b8460356ull, 0x8a892abaf368f137ull,
+    0xd01fef10a657842cull, 0x2d2b7569b0432d85ull,
+    0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull,
+    0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full,
+    0xcb3f2f7642717713ull, 0x241c70a936219a73ull,
+    0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull,
+    0x9ec95d1463e8a506ull, 0xf4363804324a40aaull,
+    0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull,
+    0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull,
+    0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull,
+    0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull,
+    0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull,
+    0x976e41088617ca01ull, 0xd5be0503e085d813ull,
+    0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull,
+    0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull,
+    0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull,
+    0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull,
+    0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull,
+    0x906a617d450187e2ull, 0x27fb2b80668b24c5ull,
+    0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull,
+    0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull,
+    0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull,
+    0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull,
+    0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull,
+    0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull,
+    0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull,
+    0xd732290fbacaf133ull, 0xa97c177947ad4095ull,
+    0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull,
+    0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull,
+    0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull,
+    0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull,
+    0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull,
+    0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull,
+    0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull,
+    0xa0555e361951c366ull, 0xd7e105bcc332621full,
+    0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull,
+    0xfa856334878fc150ull, 0xb14f98f6f0feb951ull,
+    0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull,
+    0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull,
+    0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull,
+    0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull,
+    0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull,
+    0xeeea5d5004981478ull, 0x1858ccfce06cac74ull,
+    0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull,
+    0xbaa718e68396cffdull, 0xd30560258f54e6baull,
+    0xe950df20247c83fdull, 0x47c6b82ef32a2069ull,
+    0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull,
+    0xb6472e511c81471dull, 0xe0133fe4adf8e952ull,
+    0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull,
+    0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull,
+};
+
+// w * 10^q for w != 0, false if 128 bits of 5^q cannot tell which double is
+// nearest, or the result is subnormal or infinite
+static bool eisel_lemire(u64 w, i64 q, bool negative, double *out) {
+    if (q < NUMBER_MIN_POW10) {
+        *out = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (q > NUMBER_MAX_POW10) {
+        *out = negative ? -HUGE_VAL : HUGE_VAL;
+        return true;
+    }
+
+    // floor(log2(10^q)), with the bias and the 63 bits of w on top
+    i64 exponent = (((152170 + 65536) * q) >> 16) + 1024 + 63;
+    u32 lz = ag_clz64(w);
+    w <<= lz;
+
+    size_t index = 2 * (size_t)(q - NUMBER_MIN_POW10);
+    u64 high;
+    u64 low = ag_mul128(w, powers_of_five[index], &high);
+    if ((high & 0x1FF) == 0x1FF) {
+        // the truncated bits could carry into the 54 we keep
+        u64 carry;
+        ag_mul128(w, powers_of_five[index + 1], &carry);
+        low += carry;
+        high += low < carry;
+        if (low == UINT64_MAX) {
+            return false;
+        }
+    }
+
+    u64 upper_bit = high >> 63;
+    u64 mantissa = high >> (upper_bit + 9);
+    lz += (u32)(1 ^ upper_bit);
+    if (low == 0 && (high & 0x1FF) == 0 && (mantissa & 3) == 1) {
+        return false; // exactly between two doubles
+    }
+
+    // round to nearest, ties to even
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((u64)1 << 53)) {
+        mantissa = (u64)1 << 52;
+        lz -= 1;
+    }
+    mantissa &= ~((u64)1 << 52);
+
+    i64 biased = exponent - lz;
+    if (biased < 1 || biased > 2046) {
+        return false;
+    }
+    u64 bits = mantissa | ((u64)biased << 52) | ((u64)negative << 63);
+    memcpy(out, &bits, sizeof(bits));
+    return true;
+}
+
+static bool digits_to_double(u64 w, i64 q, bool negative, double *out) {
+    if (w == 0) {
+        *out = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (w <= ((u64)1 << 53) && q >= -22 && q <= 22) {
+        // both w and 10^|q| are exact doubles, so is the one rounding
+        double d = (double)w;
+        d = q < 0 ? d / exact_powers_of_ten[-q] : d * exact_powers_of_ten[q];
+        *out = negative ? -d : d;
+        return true;
+    }
+    return eisel_lemire(w, q, negative, out);
+}
+
+#define IS_DIGIT(c) ((u8)((c) - '0') < 10)
+
+// Converts the text of a valid JSON number. False when only number_slow can
+// round it correctly.
+static bool number_from_text(u8 const *at, size_t len, jnumber_t *out) {
+    u8 const *end = at + len;
+    bool negative = *at == '-';
+    at += negative;
+
+    // the value is w * 10^q, w holding the first NUMBER_MAX_DIGITS
+    // significant digits
+    u64 w = 0;
+    i64 q = 0;
+    u32 digits = 0;
+    bool truncated = false; // nonzero digits did not fit in w
+
+    for (; at < end && IS_DIGIT(*at); ++at) {
+        u8 d = *at - '0';
+        if (digits < NUMBER_MAX_DIGITS) {
+            w = w * 10 + d;
+            digits += w != 0;
+        } else {
+            q += 1;
+            truncated |= d != 0;
+        }
+    }
+
+    if (at == end) {
+        // an integer: there are no leading zeros, so w is exact unless it
+        // took more than NUMBER_MAX_DIGITS digits
+        u64 last = at[-1] - '0';
+        if (q == 1 && w <= (UINT64_MAX - last) / 10) {
+            w = w * 10 + last;
+            q = 0;
+        }
+        if (q == 0 && !negative) {
+            out->kind = w <= INT64_MAX ? NUMBER_I64 : NUMBER_U64;
+            out->u = w;
+            return true;
+        }
+        if (q == 0 && w <= (u64)INT64_MAX + 1) {
+            out->kind = NUMBER_I64;
+            out->i = w == 0 ? 0 : -(i64)(w - 1) - 1;
+            return true;
+        }
+    } else {
+        if (*at == '.') {
+            for (++at; at < end && IS_DIGIT(*at); ++at) {
+                u8 d = *at - '0';
+                if (digits < NUMBER_MAX_DIGITS) {
+                    w = w * 10 + d;
+                    digits += w != 0;
+                    q -= 1;
+                } else {
+                    truncated |= d != 0;
+                }
+            }
+        }
+        if (at < end) {
+            // 'e' or 'E'
+            at += 1;
+            bool negative_exponent = *at == '-';
+            at += *at == '-' || *at == '+';
+            i64 exponent = 0;
+            for (; at < end; ++at) {
+                // saturates far beyond any exponent that still matters
+                if (exponent < 0x10000000) {
+                    exponent = exponent * 10 + (*at - '0');
+                }
+            }
+            q += negative_exponent ? -exponent : exponent;
+        }
+    }
+
+    out->kind = NUMBER_F64;
+    if (!digits_to_double(w, q, negative, &out->f)) {
+        return false;
+    }
+    if (truncated) {
+        // the digits cut off push the value up to less than w + 1, if both
+        // ends round to the same double that is the one
+        double above;
+        if (!digits_to_double(w + 1, q, negative, &above) ||
+            above != out->f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// strtod() for what number_from_text() leaves, on NUL-terminated text
+static jnumber_t number_slow(char const *text) {
+    return (jnumber_t){.kind = NUMBER_F64, .f = strtod(text, NULL)};
+}
+
+static size_t tape_emit(parser_t *parser, u8 tag, u64 payload) {
+    size_t at = parser->tape_len;
+    if (parser->tape == NULL) {
+        return at;
+    }
+    if (at >= parser->max_tape) {
+        parser->out_of_space = true;
+        return at;
+    }
+    parser->tape[at] = TAPE_WORD(tag, payload);
+    parser->tape_len += 1;
+    return at;
+}
+
+static void tape_emit_slice(parser_t *parser, u8 tag, byte_slice slice) {
+    // the interner counts the NUL terminator in .len
+    tape_emit(parser, tag, slice.len - 1);
+    if (parser->tape == NULL) {
+        return;
+    }
+    if (parser->tape_len >= parser->max_tape) {
+        parser->out_of_space = true;
+        return;
+    }
+    parser->tape[parser->tape_len++] = (u64)(uintptr_t)slice.at;
+}
+
+// emits a number as described above the tape, nothing without one
+static void tape_emit_number(parser_t *parser, byte_slice text) {
+    if (parser->tape == NULL) {
+        return;
+    }
+    if (parser->raw_numbers) {
+        byte_slice interned = intern_string(parser->interner, text);
+        tape_emit_slice(parser, J_NUMBER, interned);
+        return;
+    }
+    jnumber_t number;
+    if (!number_from_text(text.at, text.len, &number)) {
+        // the interner NUL-terminates the text for strtod()
+        byte_slice interned = intern_string(parser->interner, text);
+        number = number_slow((char const *)interned.at);
+    }
+    tape_emit(parser, J_NUMBER, (u64)number.kind << TAPE_NUMBER_SHIFT);
+    if (parser->tape_len >= parser->max_tape) {
+        parser->out_of_space = true;
+        return;
+    }
+    parser->tape[parser->tape_len++] = number.u;
+}
+
+// emits the string token under the cursor and moves past it, interning it on
+// the way (nothing is interned without a tape)
+static void tape_emit_token(parser_t *parser, u8 tag) {
+    if (parser->tape != NULL) {
+        packed_token_t packed = parser->tokens[parser->position];
+        byte_slice bytes = token_bytes(parser->bytes, packed);
+        tape_emit_slice(parser, tag,
+                        TOKEN_ESCAPED(packed)
+                            ? intern_escaped(parser->interner, bytes)
+                            : intern_string(parser->interner, bytes));
+    }
+    advance(parser);
+}
+
+// closes the container opened at `open`, linking both ends
+static void tape_close(parser_t *parser, size_t open, u8 tag) {
+    size_t close = tape_emit(parser, tag, open);
+    if (parser->tape != NULL && open < parser->tape_len) {
+        parser->tape[open] = TAPE_WORD(TAPE_TAG(parser->tape[open]), close);
+    }
+}
+
+#define INITIAL_STACK_DEPTH 64
+
+// false past `max_depth`, or when the stack cannot grow (out_of_space)
+static bool push_container(parser_t *parser, u8 kind) {
+    if (parser->max_depth != 0 && parser->depth >= parser->max_depth) {
+        return false;
+    }
+    if (parser->depth == parser->stack_cap) {
+        size_t new_cap = parser->stack_cap == 0 ? INITIAL_STACK_DEPTH
+                                                : parser->stack_cap * 2;
+        container_frame_t *new_stack;
+        if (!parser->allocator.alloc(new_cap * sizeof(container_frame_t),
+                                     (u8 **)&new_stack)) {
+            parser->out_of_space = true;
+            return false;
+        }
+        if (parser->stack != NULL) {
+            memcpy(new_stack, parser->stack,
+                   parser->depth * sizeof(container_frame_t));
+            parser->allocator.free((u8 *)parser->stack);
+        }
+        parser->stack = new_stack;
+        parser->stack_cap = new_cap;
+    }
+    parser->stack[parser->depth++] = (container_frame_t){.kind = kind};
+    return true;
+}
+
+// Open containers go on the parser's stack (see push_container) rather than
+// the C stack, so nesting is bounded by `max_depth` and memory, not by the
+// thread's stack size.
+static jvalue_kind_t parse_value(parser_t *parser) {
+    assert(TOKEN_KIND(parser->tokens[parser->len - 1]) == T_EOF);
+    // dbg("token: %s", format_token(peek_token(parser)));
+    jvalue_kind_t kind;
+
+value:
+    switch (peek_kind(parser)) {
+    // obj
+    case T_LEFT_CURLY:
+        if (!push_container(parser, J_OBJECT)) {
+            goto error;
+        }
+        advance(parser);
+        parser->stack[parser->depth - 1].tape_open =
+            tape_emit(parser, J_OBJECT, 0);
+        if (consume_token(parser, T_RIGHT_CURLY)) {
+            goto close;
+        }
+        goto key;
+
+    // array
+    case T_LEFT_BRACKET:
+        if (!push_container(parser, J_ARRAY)) {
+            goto error;
+        }
+        advance(parser);
+        parser->stack[parser->depth - 1].tape_open =
+            tape_emit(parser, J_ARRAY, 0);
+        if (consume_token(parser, T_RIGHT_BRACKET)) {
+            goto close;
+        }
+        goto value;
 
     // string
     case T_STRING_LIT:
-        advance(parser);
-        return J_STRING;
+        tape_emit_token(parser, J_STRING);
+        kind = J_STRING;
+        break;
 
     case T_NUMBER_LIT:
+        tape_emit_number(parser, token_bytes(parser->bytes,
+                                             parser->tokens[parser->position]));
         advance(parser);
-        return J_NUMBER;
+        kind = J_NUMBER;
+        break;
 
     case T_TRUE:
         advance(parser);
-        return J_TRUE;
+        tape_emit(parser, J_TRUE, 0);
+        kind = J_TRUE;
+        break;
 
     case T_FALSE:
         advance(parser);
-        return J_FALSE;
+        tape_emit(parser, J_FALSE, 0);
+        kind = J_FALSE;
+        break;
 
     case T_NULL:
         advance(parser);
-        return J_NULL;
+        tape_emit(parser, J_NULL, 0);
+        kind = J_NULL;
+        break;
+
+    default:
+        // no value at all is only an error inside a container
+        if (parser->depth == 0) {
+            return J_NONE;
+        }
+        goto error;
+    }
+
+done:
+    if (parser->depth == 0) {
+        return kind;
+    }
+    // after a value inside a container
+    if (parser->stack[parser->depth - 1].kind == J_OBJECT) {
+        if (consume_token(parser, T_COMMA)) {
+            goto key;
+        }
+        if (!consume_token(parser, T_RIGHT_CURLY)) {
+            goto error;
+        }
+    } else {
+        if (consume_token(parser, T_COMMA)) {
+            goto value;
+        }
+        if (!consume_token(parser, T_RIGHT_BRACKET)) {
+            goto error;
+        }
+    }
+
+close: {
+    container_frame_t frame = parser->stack[--parser->depth];
+    tape_close(parser, frame.tape_open,
+               frame.kind == J_OBJECT ? TAPE_OBJECT_END : TAPE_ARRAY_END);
+    kind = frame.kind;
+    goto done;
+}
+
+key:
+    if (peek_kind(parser) != T_STRING_LIT) {
+        goto error;
+    }
+    tape_emit_token(parser, J_STRING);
+    if (!consume_token(parser, T_COLON)) {
+        goto error;
+    }
+    goto value;
+
+error:
+    parser->depth = 0;
+    return J_ERROR;
+}
+
+/*
+Push parser: the same grammar as parse_value(), fed one token at a time.
+Open containers live on the same explicit stack, and the state says what
+comes next, so a parse can be suspended between any two tokens.
+*/
+typedef enum parse_state {
+    P_VALUE = 0,       // a value must follow
+    P_VALUE_OR_CLOSE,  // right after '['
+    P_KEY,             // after ',' in an object
+    P_KEY_OR_CLOSE,    // right after '{'
+    P_COLON,           // after a key
+    P_COMMA_OR_CLOSE,  // after a value inside a container
+    P_DONE,            // the root value is complete, only T_EOF may follow
+    P_END,             // T_EOF seen
+    P_ERROR,
+} parse_state_t;
+
+static bool value_done(parser_t *parser, u8 kind) {
+    if (parser->depth == 0) {
+        parser->root = kind;
+        parser->state = P_DONE;
+    } else {
+        parser->state = P_COMMA_OR_CLOSE;
+    }
+    return true;
+}
+
+static bool parse_token(parser_t *parser, token_t t) {
+    switch (parser->state) {
+    case P_VALUE_OR_CLOSE:
+        if (t.kind == T_RIGHT_BRACKET) {
+            goto close_container;
+        }
+        // fallthrough
+    case P_VALUE:
+        switch (t.kind) {
+        case T_LEFT_CURLY:
+        case T_LEFT_BRACKET: {
+            u8 kind = t.kind == T_LEFT_CURLY ? J_OBJECT : J_ARRAY;
+            if (!push_container(parser, kind)) {
+                break;
+            }
+            parser->stack[parser->depth - 1].tape_open =
+                tape_emit(parser, kind, 0);
+            parser->state = kind == J_OBJECT ? P_KEY_OR_CLOSE : P_VALUE_OR_CLOSE;
+            return true;
+        }
+        case T_STRING_LIT:
+            tape_emit_slice(parser, J_STRING, t.byte_sequence);
+            return value_done(parser, J_STRING);
+        case T_NUMBER_LIT:
+            tape_emit_number(parser, t.byte_sequence);
+            return value_done(parser, J_NUMBER);
+        case T_TRUE:
+            tape_emit(parser, J_TRUE, 0);
+            return value_done(parser, J_TRUE);
+        case T_FALSE:
+            tape_emit(parser, J_FALSE, 0);
+            return value_done(parser, J_FALSE);
+        case T_NULL:
+            tape_emit(parser, J_NULL, 0);
+            return value_done(parser, J_NULL);
+        case T_EOF:
+            if (parser->depth == 0 && parser->state == P_VALUE) {
+                // empty document
+                parser->root = J_NONE;
+                parser->state = P_END;
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+        break;
+
+    case P_KEY_OR_CLOSE:
+        if (t.kind == T_RIGHT_CURLY) {
+            goto close_container;
+        }
+        // fallthrough
+    case P_KEY:
+        if (t.kind == T_STRING_LIT) {
+            tape_emit_slice(parser, J_STRING, t.byte_sequence);
+            parser->state = P_COLON;
+            return true;
+        }
+        break;
+
+    case P_COLON:
+        if (t.kind == T_COLON) {
+            parser->state = P_VALUE;
+            return true;
+        }
+        break;
+
+    case P_COMMA_OR_CLOSE: {
+        u8 top = parser->stack[parser->depth - 1].kind;
+        if (t.kind == T_COMMA) {
+            parser->state = top == J_OBJECT ? P_KEY : P_VALUE;
+            return true;
+        }
+        if (t.kind == (top == J_OBJECT ? T_RIGHT_CURLY : T_RIGHT_BRACKET)) {
+            goto close_container;
+        }
+    } break;
+
+    case P_DONE:
+        if (t.kind == T_EOF) {
+            parser->state = P_END;
+            return true;
+        }
+        break;
 
     default:
-        return J_NONE;
+        break;
+    }
+
+    parser->state = P_ERROR;
+    return false;
+
+close_container: {
+    container_frame_t frame = parser->stack[--parser->depth];
+    tape_close(parser, frame.tape_open,
+               frame.kind == J_OBJECT ? TAPE_OBJECT_END : TAPE_ARRAY_END);
+    return value_done(parser, frame.kind);
+}
+}
+
+// the result of a push parser that reached P_END
+static agnes_result_t parsed_result(parser_t const *parser, size_t *tape_len) {
+    if (parser->out_of_space) {
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    } else if (parser->root == J_NONE) {
+        return (agnes_result_t){.kind = RES_PARSER_NONE};
+    }
+    *tape_len = parser->tape_len;
+    return (agnes_result_t){.kind = RES_PARSER_SOME, .jvalue = parser->root};
+}
+
+static void free_stack(parser_t *parser) {
+    if (parser->stack != NULL) {
+        parser->allocator.free((u8 *)parser->stack);
+        parser->stack = NULL;
     }
 }
 
 #define ATLEAST_PAGE(n) (n < KiB(4) ? KiB(4) : n)
 
-agnes_result_t parse_json(agnes_parser_t *agnes_parser) {
+#if AG_STATS
+// The time of a phase, without the interning done meanwhile (which goes to
+// intern_ns instead).
+typedef struct phase_clock {
+    u64 at;
+    u64 interned;
+} phase_clock_t;
+
+static phase_clock_t phase_start(agnes_stats_t const *stats) {
+    return (phase_clock_t){ag_now_ns(), stats->intern_ns};
+}
+
+static u64 phase_ns(agnes_stats_t const *stats, phase_clock_t *clock) {
+    phase_clock_t now = phase_start(stats);
+    u64 ns = (now.at - clock->at) - (now.interned - clock->interned);
+    *clock = now;
+    return ns;
+}
+#endif
+
+// parse_json() without a token buffer: the lexer pushes every token into
+// parse_token() as it goes, like when streaming. With a session, the parser's
+// stack comes from it and goes back to it.
+static agnes_result_t parse_fused(agnes_parser_t *agnes_parser,
+                                  interner_t *interner,
+                                  agnes_session_t *session) {
+    parser_t parser = {.filename = agnes_parser->filename,
+                       .interner = interner,
+                       .tape = agnes_parser->tape,
+                       .max_tape = agnes_parser->max_tape,
+                       .raw_numbers = agnes_parser->raw_numbers,
+                       .max_depth = agnes_parser->max_depth,
+                       .allocator = agnes_parser->string_allocator};
+    if (session != NULL) {
+        parser.stack = session->stack;
+        parser.stack_cap = session->stack_cap;
+    }
+    lexer_t lexer = {
+        .filename = agnes_parser->filename,
+        .bytes = agnes_parser->bytes,
+        .len = agnes_parser->file_size,
+        .first_line = 1,
+        .first_column = 1,
+        .interner = interner,
+        .sink = &parser,
+    };
+    agnes_parser->tape_len = 0;
+
+    STAT(agnes_stats_t *stats = interner->stats;
+         phase_clock_t clock = stats ? phase_start(stats) : (phase_clock_t){0});
+    agnes_result_t res = tokenize(&lexer);
+    STAT(if (stats != NULL) { stats->parse_ns += phase_ns(stats, &clock); });
+    if (res.kind == RES_LEXER_NONE) {
+        res = parsed_result(&parser, &agnes_parser->tape_len);
+    } else if (res.kind == RES_OUT_OF_SPACE && parser.state == P_ERROR &&
+               !parser.out_of_space) {
+        // push_token() fails when the parser rejects a token
+        res = lexer_error(&lexer, RES_PARSER_ERROR);
+    }
+
+    if (session != NULL) {
+        session->stack = parser.stack;
+        session->stack_cap = parser.stack_cap;
+    } else {
+        free_stack(&parser);
+    }
+    return res;
+}
+
+// parse_json() with an interner that is already initialised
+static agnes_result_t parse_document(agnes_parser_t *agnes_parser,
+                                     interner_t *interner,
+                                     agnes_session_t *session) {
+    if (agnes_parser->validate_utf8) {
+        size_t bad = utf8_error_at(agnes_parser->bytes, agnes_parser->file_size);
+        if (bad < agnes_parser->file_size) {
+            agnes_result_t res = {.kind = RES_LEXER_ERROR,
+                                  .byte_pos = bad,
+                                  .line = 1,
+                                  .column = 1};
+            locate(agnes_parser->bytes, bad, &res.line, &res.column);
+            return res;
+        }
+    }
+    if (agnes_parser->tokens == NULL) {
+        return parse_fused(agnes_parser, interner, session);
+    }
+    if (agnes_parser->file_size > PACKED_MAX_INPUT) {
+        // too large for the offsets in packed tokens, see AG_LARGE_INPUT
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+
     lexer_t lexer = {
         .filename = agnes_parser->filename,
         .bytes = agnes_parser->bytes,
@@ -642,17 +3155,22 @@ agnes_result_t parse_json(agnes_parser_t *agnes_parser) {
         .max_tokens = agnes_parser->max_tokens,
         .next_token = 0,
 
-        .line_info = agnes_parser->line_info,
-        .current_line = 1,
+        .first_line = 1,
+        .first_column = 1,
+        .interner = interner,
     };
 
-    bool result = init_global_interner(&global_string_interner,
-                                       agnes_parser->string_allocator,
-                                       ATLEAST_PAGE(agnes_parser->file_size));
-
-    assert(global_string_interner.next_string != UINT64_MAX && result);
-
-    agnes_result_t res = tokenize(&lexer);
+    STAT(agnes_stats_t *stats = interner != NULL ? interner->stats : NULL;
+         phase_clock_t clock = stats ? phase_start(stats) : (phase_clock_t){0});
+    agnes_result_t res =
+        agnes_parser->threads > 1
+            ? tokenize_parallel(&lexer, agnes_parser->threads,
+                                agnes_parser->string_allocator)
+            : tokenize(&lexer);
+    STAT(if (stats != NULL) {
+        stats->tokenize_ns += phase_ns(stats, &clock);
+        stats->tokens = lexer.next_token;
+    });
     if (res.kind == RES_LEXER_ERROR || res.kind == RES_OUT_OF_SPACE) {
         return res;
     }
@@ -660,24 +3178,754 @@ agnes_result_t parse_json(agnes_parser_t *agnes_parser) {
     parser_t parser = {.filename = lexer.filename,
                        .tokens = lexer.tokens,
                        .len = lexer.next_token,
-                       .position = 0};
+                       .position = 0,
+                       .bytes = lexer.bytes,
+                       .interner = interner,
+                       .tape = agnes_parser->tape,
+                       .max_tape = agnes_parser->max_tape,
+                       .raw_numbers = agnes_parser->raw_numbers,
+                       .max_depth = agnes_parser->max_depth,
+                       .allocator = agnes_parser->string_allocator};
+    agnes_parser->tape_len = 0;
 
     // TODO(yousef): make this check more friendly
     if (parser.len < 1) {
         panic("file=%s: parser->len<1", parser.filename);
     }
-    if (parser.tokens[0].kind == T_EOF) {
+    if (TOKEN_KIND(parser.tokens[0]) == T_EOF) {
         return (agnes_result_t){.kind = RES_PARSER_NONE};
     }
 
+    if (session != NULL) {
+        parser.stack = session->stack;
+        parser.stack_cap = session->stack_cap;
+    }
     jvalue_kind_t v = parse_value(&parser);
+    bool at_eof = consume_token(&parser, T_EOF);
+    STAT(if (stats != NULL) { stats->parse_ns += phase_ns(stats, &clock); });
+    if (session != NULL) {
+        session->stack = parser.stack;
+        session->stack_cap = parser.stack_cap;
+    } else {
+        free_stack(&parser);
+    }
 
-    if (!consume_token(&parser, T_EOF) || v == J_ERROR) {
-        return (agnes_result_t){.kind = RES_PARSER_ERROR};
+    if (v == J_ERROR && parser.out_of_space) {
+        // out of tape or stack memory, reported like parse_fused() does
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+    if (!at_eof || v == J_ERROR) {
+        // where the parser stopped, which is at or right after the problem
+        size_t at = parser.tokens[parser.position < parser.len
+                                      ? parser.position
+                                      : parser.len - 1]
+                        .offset;
+        agnes_result_t res = {.kind = RES_PARSER_ERROR,
+                              .byte_pos = at,
+                              .line = 1,
+                              .column = 1};
+        locate(lexer.bytes, at, &res.line, &res.column);
+        return res;
+    }
+    if (parser.out_of_space) {
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
     }
+    agnes_parser->tape_len = parser.tape_len;
 
     return (agnes_result_t){.kind = RES_PARSER_SOME, .jvalue = v};
 }
 
+// What the last parse_json or stream interned is freed before the interner
+// is set up again, rather than reset: the options and the input's size can
+// change from one call to the next. Must come before the options are set,
+// `reserve` is the size of the reservation to release.
+static void release_global_interner(void) {
+    if (global_string_interner.next_string != UINT64_MAX) {
+        free_and_invalidate(&global_string_interner);
+    }
+}
+
+agnes_result_t parse_json(agnes_parser_t *agnes_parser) {
+    release_global_interner();
+    global_string_interner.max_load = agnes_parser->intern_max_load;
+    global_string_interner.reserve = agnes_parser->intern_reserve;
+    global_string_interner.known_keys = agnes_parser->known_keys;
+    global_string_interner.known_key_count = agnes_parser->known_key_count;
+    global_string_interner.stats = NULL;
+    bool result = init_interner(&global_string_interner,
+                                agnes_parser->string_allocator,
+                                ATLEAST_PAGE(agnes_parser->file_size),
+                                table_cap_for(agnes_parser->file_size));
+
+    assert(global_string_interner.next_string != UINT64_MAX && result);
+
+#if AG_STATS
+    agnes_stats_t *stats = agnes_parser->stats;
+    if (stats != NULL) {
+        *stats = (agnes_stats_t){0};
+        global_string_interner.stats = stats;
+    }
+    agnes_result_t res =
+        parse_document(agnes_parser, &global_string_interner, NULL);
+    if (stats != NULL) {
+        count_pools(&global_string_interner, stats);
+        // the caller's stats may not outlive this call
+        global_string_interner.stats = NULL;
+    }
+    return res;
+#else
+    return parse_document(agnes_parser, &global_string_interner, NULL);
+#endif
+}
+
+// The lexer never reads past `file_size` (the last block is copied into a
+// padded one, see tokenize), so the mapping needs no padding and the
+// input is not copied at all.
+agnes_result_t agnes_parse_file(agnes_parser_t *agnes_parser,
+                                char const *path) {
+    size_t size = 0;
+    u8 const *bytes = ag_map_file(path, &size);
+    if (bytes == NULL) {
+        return (agnes_result_t){.kind = RES_IO_ERROR};
+    }
+    agnes_parser->bytes = bytes;
+    agnes_parser->file_size = size;
+    if (agnes_parser->filename == NULL) {
+        agnes_parser->filename = path;
+    }
+    return parse_json(agnes_parser);
+}
+
+void agnes_unmap_file(agnes_parser_t *agnes_parser) {
+    ag_unmap_file(agnes_parser->bytes, agnes_parser->file_size);
+    agnes_parser->bytes = NULL;
+    agnes_parser->file_size = 0;
+}
+
+bool agnes_session_init(agnes_session_t *session, size_t expected_size) {
+    session->interner = (interner_t){.max_load = session->intern_max_load,
+                                     .reserve = session->intern_reserve,
+                                     .known_keys = session->known_keys,
+                                     .known_key_count =
+                                         session->known_key_count};
+    session->stack = NULL;
+    session->stack_cap = 0;
+    return init_interner(&session->interner, session->string_allocator,
+                         ATLEAST_PAGE(expected_size),
+                         table_cap_for(expected_size));
+}
+
+// parse_json() into the session's interner, which is not reset first: the
+// strings of earlier documents stay valid (and keep their ids) until
+// agnes_session_reset. `string_allocator` and the `intern_*` options of
+// `agnes_parser` are not used, the session's are.
+agnes_result_t agnes_session_parse(agnes_session_t *session,
+                                   agnes_parser_t *agnes_parser) {
+    agnes_parser_t document = *agnes_parser;
+    document.string_allocator = session->string_allocator;
+#if AG_STATS
+    agnes_stats_t *stats = agnes_parser->stats;
+    if (stats != NULL) {
+        *stats = (agnes_stats_t){0};
+        session->interner.stats = stats;
+    }
+#endif
+    agnes_result_t res =
+        parse_document(&document, &session->interner, session);
+#if AG_STATS
+    if (stats != NULL) {
+        count_pools(&session->interner, stats);
+        session->interner.stats = NULL;
+    }
+#endif
+    agnes_parser->tape_len = document.tape_len;
+    return res;
+}
+
+void agnes_session_reset(agnes_session_t *session) {
+    reset_interner(&session->interner);
+}
+
+void agnes_session_free(agnes_session_t *session) {
+    free_and_invalidate(&session->interner);
+    if (session->stack != NULL) {
+        session->string_allocator.free((u8 *)session->stack);
+        session->stack = NULL;
+        session->stack_cap = 0;
+    }
+}
+
+/*
+NDJSON batches: a record is a line, the last one may lack its '\n'.
+The buffer is cut into slices at line boundaries (a few per thread, so that
+one slow slice does not hold up the rest) and slice i goes to thread
+i % threads. Every thread has its own token buffer, nothing is shared but
+the input and the results array. Without `tapes` nothing is interned: a lexer
+error's fragment points into the input. With them, every thread also has a
+tape buffer and an interner (its batch_output_t), or interns into the batch's
+sharded one with `shard_count`. Both outlive the batch.
+*/
+
+#define BATCH_SLICES_PER_THREAD 8
+
+typedef struct batch_slice {
+    size_t begin;
+    size_t end; // right after a '\n', or the end of the input
+    size_t first_record;
+} batch_slice_t;
+
+typedef struct batch_worker {
+    agnes_batch_t *batch;
+    batch_slice_t const *slices;
+    size_t slice_count;
+    size_t first_slice;
+    size_t stride;
+    batch_output_t *output; // NULL without `tapes`
+    bool failed;
+} batch_worker_t;
+
+size_t count_records(u8 const *bytes, size_t size) {
+    return count_newlines(bytes, size) +
+           (size > 0 && bytes[size - 1] != '\n');
+}
+
+static AG_THREAD_PROC(batch_worker_proc) {
+    batch_worker_t *worker = (batch_worker_t *)arg;
+    agnes_batch_t *batch = worker->batch;
+    allocator_t allocator = batch->string_allocator;
+    batch_output_t *output = worker->output;
+
+    interner_t *interner = NULL;
+    packed_token_t *tokens = NULL;
+    size_t max_tokens = 0;
+    // only for its parser stack, kept from one record to the next
+    agnes_session_t session = {0};
+
+    if (output != NULL && batch->interner.shards != NULL) {
+        interner = &batch->interner;
+    } else if (output != NULL) {
+        output->interner =
+            (interner_t){.next_string = UINT64_MAX,
+                         .max_load = batch->intern_max_load,
+                         .reserve = batch->intern_reserve,
+                         .known_keys = batch->known_keys,
+                         .known_key_count = batch->known_key_count};
+        if (!init_global_interner(&output->interner, allocator,
+                                  ATLEAST_PAGE(batch->size / worker->stride))) {
+            worker->failed = true;
+            AG_THREAD_RETURN;
+        }
+        interner = &output->interner;
+    }
+
+    for (size_t i = worker->first_slice; i < worker->slice_count;
+         i += worker->stride) {
+        batch_slice_t slice = worker->slices[i];
+        size_t record = slice.first_record;
+
+        for (size_t at = slice.begin; at < slice.end; ++record) {
+            u8 const *newline =
+                memchr(batch->bytes + at, '\n', slice.end - at);
+            size_t end = newline ? (size_t)(newline - batch->bytes) : slice.end;
+
+            // a token is at least one byte long, plus T_EOF
+            if (!grow_token_buffer(allocator, end - at + 1, 0, &tokens,
+                                   &max_tokens)) {
+                worker->failed = true;
+                goto done;
+            }
+            // and at most two tape words per token
+            if (output != NULL &&
+                !grow_buffer(allocator, output->tape_len + 2 * max_tokens,
+                             output->tape_len, sizeof(u64),
+                             (u8 **)&output->tape, &output->max_tape)) {
+                worker->failed = true;
+                goto done;
+            }
+
+            agnes_parser_t parser = {
+                .filename = "ndjson",
+                .bytes = batch->bytes + at,
+                .file_size = end - at,
+                .tokens = tokens,
+                .max_tokens = max_tokens,
+                .string_allocator = allocator,
+                .raw_numbers = batch->raw_numbers,
+            };
+            if (output != NULL) {
+                parser.tape = output->tape + output->tape_len;
+                parser.max_tape = output->max_tape - output->tape_len;
+            }
+            agnes_result_t res = parse_document(&parser, interner, &session);
+
+            if (output != NULL && res.kind == RES_PARSER_SOME) {
+                batch->records[record] = (batch_record_t){
+                    .output = (size_t)(output - batch->outputs),
+                    .at = output->tape_len,
+                    .tape_len = parser.tape_len,
+                };
+                output->tape_len += parser.tape_len;
+            }
+            if (res.kind == RES_LEXER_ERROR || res.kind == RES_PARSER_ERROR) {
+                res.byte_pos += at;
+            }
+            res.line = record + 1;
+            batch->results[record] = res;
+
+            at = end + 1;
+        }
+    }
+
+done:
+    if (tokens != NULL) {
+        allocator.free((u8 *)tokens);
+    }
+    if (session.stack != NULL) {
+        allocator.free((u8 *)session.stack);
+    }
+    AG_THREAD_RETURN;
+}
+
+agnes_result_t parse_ndjson(agnes_batch_t *batch) {
+    u8 const *bytes = batch->bytes;
+    size_t size = batch->size;
+
+    agnes_batch_free(batch);
+    batch->record_count = count_records(bytes, size);
+    if (batch->record_count > batch->max_results) {
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+
+    size_t threads = batch->threads == 0 ? ag_cpu_count() : batch->threads;
+    if (batch->tapes) {
+        if (!batch->string_allocator.alloc(threads * sizeof(batch_output_t),
+                                           (u8 **)&batch->outputs)) {
+            return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+        }
+        batch->output_count = threads;
+        for (size_t t = 0; t < threads; ++t) {
+            batch->outputs[t] = (batch_output_t){
+                .interner = {.next_string = UINT64_MAX}};
+        }
+        // + 1 so that an empty batch still gets an allocation to free
+        if (!batch->string_allocator.alloc((batch->record_count + 1) *
+                                               sizeof(batch_record_t),
+                                           (u8 **)&batch->records)) {
+            return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+        }
+    }
+    if (batch->tapes && batch->shard_count > 1) {
+        batch->interner =
+            (interner_t){.max_load = batch->intern_max_load,
+                         .reserve = batch->intern_reserve,
+                         .shard_count = batch->shard_count,
+                         .known_keys = batch->known_keys,
+                         .known_key_count = batch->known_key_count};
+        if (!init_global_interner(&batch->interner, batch->string_allocator,
+                                  ATLEAST_PAGE(size))) {
+            return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+        }
+    }
+
+    size_t slice_count = threads * BATCH_SLICES_PER_THREAD;
+    batch_slice_t *slices;
+    batch_worker_t *workers;
+    ag_thread_t *handles;
+
+    if (!batch->string_allocator.alloc(slice_count * sizeof(batch_slice_t),
+                                       (u8 **)&slices)) {
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+    if (!batch->string_allocator.alloc(threads * (sizeof(batch_worker_t) +
+                                                  sizeof(ag_thread_t)),
+                                       (u8 **)&workers)) {
+        batch->string_allocator.free((u8 *)slices);
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+    handles = (ag_thread_t *)(workers + threads);
+
+    size_t target = size / slice_count + 1;
+    size_t begin = 0;
+    size_t record = 0;
+    for (size_t i = 0; i < slice_count; ++i) {
+        size_t end = begin + target < size ? begin + target : size;
+        u8 const *newline = memchr(bytes + end, '\n', size - end);
+        end = newline ? (size_t)(newline - bytes) + 1 : size;
+        if (i + 1 == slice_count) {
+            end = size;
+        }
+
+        slices[i] = (batch_slice_t){begin, end, record};
+        record += count_records(bytes + begin, end - begin);
+        begin = end;
+    }
+    assert(record == batch->record_count);
+
+    for (size_t t = 0; t < threads; ++t) {
+        workers[t] = (batch_worker_t){
+            .batch = batch,
+            .slices = slices,
+            .slice_count = slice_count,
+            .first_slice = t,
+            .stride = threads,
+            .output = batch->tapes ? &batch->outputs[t] : NULL,
+        };
+    }
+
+    // the calling thread takes the first share
+    size_t started = 1;
+    for (; started < threads; ++started) {
+        if (!ag_thread_start(&handles[started], batch_worker_proc,
+                             &workers[started])) {
+            break;
+        }
+    }
+    for (size_t t = started; t < threads; ++t) {
+        batch_worker_proc(&workers[t]); // could not start a thread for it
+    }
+    batch_worker_proc(&workers[0]);
+    for (size_t t = 1; t < started; ++t) {
+        ag_thread_join(handles[t]);
+    }
+
+    bool failed = false;
+    for (size_t t = 0; t < threads; ++t) {
+        failed |= workers[t].failed;
+    }
+
+    batch->string_allocator.free((u8 *)workers);
+    batch->string_allocator.free((u8 *)slices);
+
+    if (failed) {
+        return (agnes_result_t){.kind = RES_OUT_OF_SPACE};
+    }
+    return (agnes_result_t){.kind = RES_NONE};
+}
+
+tape_iter_t batch_tape(agnes_batch_t const *batch, size_t record,
+                       size_t *tape_len) {
+    assert(batch->records != NULL && record < batch->record_count &&
+           batch->results[record].kind == RES_PARSER_SOME);
+    batch_record_t r = batch->records[record];
+    if (tape_len != NULL) {
+        *tape_len = r.tape_len;
+    }
+    return (tape_iter_t){.tape = batch->outputs[r.output].tape + r.at,
+                         .at = 0};
+}
+
+void agnes_batch_free(agnes_batch_t *batch) {
+    allocator_t allocator = batch->string_allocator;
+    for (size_t t = 0; t < batch->output_count; ++t) {
+        batch_output_t *output = &batch->outputs[t];
+        if (output->interner.next_string != UINT64_MAX) {
+            free_and_invalidate(&output->interner);
+        }
+        if (output->tape != NULL) {
+            allocator.free((u8 *)output->tape);
+        }
+    }
+    if (batch->outputs != NULL) {
+        allocator.free((u8 *)batch->outputs);
+        batch->outputs = NULL;
+        batch->output_count = 0;
+    }
+    if (batch->records != NULL) {
+        allocator.free((u8 *)batch->records);
+        batch->records = NULL;
+    }
+    // a zeroed batch has no interner to free, nor one that failed to start
+    if (batch->interner.shards != NULL &&
+        batch->interner.next_string != UINT64_MAX) {
+        free_and_invalidate(&batch->interner);
+    }
+}
+
+#define STREAM_CARRY_SIZE 256
+
+bool agnes_begin(agnes_stream_t *stream) {
+    stream->parser = (parser_t){.filename = stream->filename,
+                                .interner = &global_string_interner,
+                                .tape = stream->tape,
+                                .max_tape = stream->max_tape,
+                                .raw_numbers = stream->raw_numbers,
+                                .max_depth = stream->max_depth,
+                                .allocator = stream->string_allocator};
+    stream->offset = 0;
+    stream->line = 1;
+    stream->column = 1;
+    stream->carry_len = 0;
+    stream->carry_escaped = false;
+    stream->error = (agnes_result_t){RES_NONE};
+    stream->tape_len = 0;
+
+    if (!stream->string_allocator.alloc(STREAM_CARRY_SIZE, &stream->carry)) {
+        return false;
+    }
+    stream->carry_cap = STREAM_CARRY_SIZE;
+
+    // no file size to go by, the pools grow as needed
+    release_global_interner();
+    global_string_interner.max_load = stream->intern_max_load;
+    global_string_interner.reserve = stream->intern_reserve;
+    global_string_interner.known_keys = stream->known_keys;
+    global_string_interner.known_key_count = stream->known_key_count;
+    return init_global_interner(&global_string_interner,
+                                stream->string_allocator, KiB(64));
+}
+
+static bool carry_append(agnes_stream_t *stream, u8 const *bytes, size_t len) {
+    if (stream->carry_len + len > stream->carry_cap) {
+        size_t new_cap = stream->carry_cap * 2;
+        while (new_cap < stream->carry_len + len) {
+            new_cap *= 2;
+        }
+        u8 *new_carry;
+        if (!stream->string_allocator.alloc(new_cap, &new_carry)) {
+            return false;
+        }
+        memcpy(new_carry, stream->carry, stream->carry_len);
+        stream->string_allocator.free(stream->carry);
+        stream->carry = new_carry;
+        stream->carry_cap = new_cap;
+    }
+    memcpy(stream->carry + stream->carry_len, bytes, len);
+    stream->carry_len += len;
+    return true;
+}
+
+// Position of the closing quote of a string whose body starts at `at`, `len`
+// if it is not within the bytes. `escaped` is the state at `at` (right after
+// a backslash or not) and is updated to the state at `len`.
+static size_t string_end(u8 const *bytes, size_t at, size_t len,
+                         bool *escaped) {
+    if (*escaped && at < len) {
+        at += 1;
+    }
+    *escaped = false;
+    while ((at = scan_string_body(bytes, at, len)) < len) {
+        if (bytes[at] == '"') {
+            return at;
+        } else if (bytes[at] == '\\') {
+            if (at + 1 == len) {
+                *escaped = true;
+                return len;
+            }
+            at += 2;
+        } else {
+            at += 1;
+        }
+    }
+    return len;
+}
+
+static agnes_result_t stream_result(agnes_stream_t *stream, agnes_result_t res,
+                                    lexer_t const *lexer, size_t offset) {
+    switch (res.kind) {
+    case RES_LEXER_PARTIAL:
+        stream->carry_len = 0;
+        stream->carry_offset = offset + lexer->begin_i;
+        stream->carry_line = lexer->first_line;
+        stream->carry_column = lexer->first_column;
+        locate(lexer->bytes, lexer->begin_i, &stream->carry_line,
+               &stream->carry_column);
+        stream->carry_escaped = false;
+        if (!carry_append(stream, lexer->bytes + lexer->begin_i,
+                          lexer->len - lexer->begin_i)) {
+            return stream->error = LEXER_OUT_OF_SPACE;
+        }
+        if (lexer->bytes[lexer->begin_i] == '"') {
+            string_end(lexer->bytes, lexer->begin_i + 1, lexer->len,
+                       &stream->carry_escaped);
+        }
+        return (agnes_result_t){RES_NONE};
+
+    case RES_LEXER_ERROR:
+        res.byte_pos += offset;
+        return stream->error = res;
+
+    case RES_OUT_OF_SPACE:
+        // push_token() fails when the parser rejects a token
+        if (stream->parser.state == P_ERROR && !stream->parser.out_of_space) {
+            res = lexer_error(lexer, RES_PARSER_ERROR);
+            res.byte_pos += offset;
+        }
+        return stream->error = res;
+
+    default:
+        return (agnes_result_t){RES_NONE};
+    }
+}
+
+// The carry holds exactly one complete run or string, and no whitespace.
+static agnes_result_t stream_lex_carry(agnes_stream_t *stream) {
+    lexer_t lexer = {
+        .filename = stream->filename,
+        .bytes = stream->carry,
+        .len = stream->carry_len,
+        .first_line = stream->carry_line,
+        .first_column = stream->carry_column,
+        .interner = &global_string_interner,
+        .sink = &stream->parser,
+    };
+    agnes_result_t res = LEXER_CONTINUE;
+
+    while (lexer.position < lexer.len && res.kind == RES_LEXER_SOME) {
+        lexer.begin_i = lexer.position;
+        res = lex_token(&lexer, consume(&lexer));
+        if (res.kind == RES_LEXER_NONE) {
+            res = push_eof(&lexer);
+        }
+    }
+    stream->carry_len = 0;
+    return stream_result(stream, res, &lexer, stream->carry_offset);
+}
+
+agnes_result_t agnes_feed(agnes_stream_t *stream, u8 const *chunk,
+                          size_t len) {
+    if (stream->error.kind != RES_NONE || stream->parser.state == P_END) {
+        return stream->error; // failed, or a '\0' ended the input early
+    }
+
+    size_t offset = stream->offset;
+    size_t line = stream->line;
+    size_t column = stream->column;
+    stream->offset += len;
+    locate(chunk, len, &stream->line, &stream->column);
+
+    size_t start = 0;
+    if (stream->carry_len > 0) {
+        // finish the token cut off at the end of the last chunk first
+        bool complete;
+        if (stream->carry[0] == '"') {
+            start = string_end(chunk, 0, len, &stream->carry_escaped);
+            complete = start < len;
+            start += complete;
+        } else {
+            while (start < len && char_class[chunk[start]] == CC_OTHER) {
+                ++start;
+            }
+            complete = start < len;
+        }
+
+        if (!carry_append(stream, chunk, start)) {
+            return stream->error = LEXER_OUT_OF_SPACE;
+        }
+        if (!complete) {
+            return (agnes_result_t){RES_NONE};
+        }
+
+        agnes_result_t res = stream_lex_carry(stream);
+        if (res.kind != RES_NONE || stream->parser.state == P_END) {
+            return res;
+        }
+    }
+
+    lexer_t lexer = {
+        .filename = stream->filename,
+        .bytes = chunk,
+        .len = len,
+        .position = start,
+        .first_line = line,
+        .first_column = column,
+        .interner = &global_string_interner,
+        .sink = &stream->parser,
+        .partial = true,
+    };
+    return stream_result(stream, tokenize(&lexer), &lexer, offset);
+}
+
+agnes_result_t agnes_finish(agnes_stream_t *stream) {
+    parser_t *parser = &stream->parser;
+    agnes_result_t res = stream->error;
+
+    if (res.kind == RES_NONE && parser->state != P_END) {
+        if (stream->carry_len > 0) {
+            res = stream_lex_carry(stream);
+        }
+        if (res.kind == RES_NONE && parser->state != P_END &&
+            !parse_token(parser, (token_t){.kind = T_EOF})) {
+            res = (agnes_result_t){.kind = RES_PARSER_ERROR,
+                                   .byte_pos = stream->offset,
+                                   .line = stream->line,
+                                   .column = stream->column};
+        }
+    }
+
+    if (res.kind == RES_NONE) {
+        res = parsed_result(parser, &stream->tape_len);
+    }
+
+    free_stack(parser);
+    stream->string_allocator.free(stream->carry);
+    stream->carry = NULL;
+    return res;
+}
+
+tape_iter_t tape_root(agnes_parser_t const *agnes_parser) {
+    return (tape_iter_t){.tape = agnes_parser->tape, .at = 0};
+}
+
+jvalue_kind_t tape_kind(tape_iter_t it) {
+    u8 tag = TAPE_TAG(it.tape[it.at]);
+    return (tag & 0x80) ? J_NONE : (jvalue_kind_t)tag;
+}
+
+bool tape_at_end(tape_iter_t it) {
+    return (TAPE_TAG(it.tape[it.at]) & 0x80) != 0;
+}
+
+tape_iter_t tape_child(tape_iter_t container) {
+    jvalue_kind_t kind = tape_kind(container);
+    assert(kind == J_OBJECT || kind == J_ARRAY);
+    return (tape_iter_t){.tape = container.tape, .at = container.at + 1};
+}
+
+tape_iter_t tape_next(tape_iter_t it) {
+    u64 word = it.tape[it.at];
+    switch (TAPE_TAG(word)) {
+    case J_OBJECT:
+    case J_ARRAY:
+        it.at = TAPE_PAYLOAD(word) + 1;
+        break;
+    case J_STRING:
+    case J_NUMBER:
+        it.at += 2;
+        break;
+    default:
+        it.at += 1;
+    }
+    return it;
+}
+
+byte_slice tape_string(tape_iter_t it) {
+    u64 word = it.tape[it.at];
+    assert(TAPE_TAG(word) == J_STRING ||
+           (TAPE_TAG(word) == J_NUMBER &&
+            TAPE_PAYLOAD(word) >> TAPE_NUMBER_SHIFT == NUMBER_RAW));
+    return (byte_slice){.at = (u8 *)(uintptr_t)it.tape[it.at + 1],
+                        .len = TAPE_PAYLOAD(word)};
+}
+
+agnes_string_t tape_string_id(tape_iter_t it) {
+    return string_id(tape_string(it));
+}
+
+jnumber_t tape_number(tape_iter_t it) {
+    u64 word = it.tape[it.at];
+    assert(TAPE_TAG(word) == J_NUMBER);
+    jnumber_t number = {
+        .kind = (number_kind_t)(TAPE_PAYLOAD(word) >> TAPE_NUMBER_SHIFT)};
+    if (number.kind != NUMBER_RAW) {
+        number.u = it.tape[it.at + 1];
+        return number;
+    }
+    byte_slice text = tape_string(it);
+    if (!number_from_text(text.at, text.len, &number)) {
+        number = number_slow((char const *)text.at);
+    }
+    return number;
+}
+
+#endif
 #endif
-#endif
\ No newline at end of file
@@ -15,7 +15,210 @@ bool stupid_alloc(size_t size, u8 **out) {
 
 void stupid_free(u8 *in) { free(in); }
 
-// arguments: [1]: filename, [2]: filesize (validated by test.py)
+static bool accepted(agnes_result_t result) {
+    return result.kind != RES_PARSER_ERROR && result.kind != RES_LEXER_ERROR &&
+           result.kind != RES_OUT_OF_SPACE && result.kind != RES_IO_ERROR;
+}
+
+// Checks the value at `it` and everything in it, returns the index right
+// after it (0 if the tape is malformed). Container ends must point at each
+// other, and strings and numbers take two words.
+static size_t check_tape_value(tape_iter_t it, size_t tape_len) {
+    if (it.at >= tape_len) {
+        return 0;
+    }
+    u64 word = it.tape[it.at];
+    size_t next = it.at + 1;
+
+    switch (TAPE_TAG(word)) {
+    case J_OBJECT:
+    case J_ARRAY: {
+        size_t close = TAPE_PAYLOAD(word);
+        if (close <= it.at || close >= tape_len ||
+            TAPE_TAG(it.tape[close]) != (0x80 | TAPE_TAG(word)) ||
+            TAPE_PAYLOAD(it.tape[close]) != it.at) {
+            return 0;
+        }
+        tape_iter_t child = tape_child(it);
+        while (child.at < close) {
+            if (TAPE_TAG(word) == J_OBJECT) {
+                // the key
+                if (tape_kind(child) != J_STRING ||
+                    check_tape_value(child, tape_len) != tape_next(child).at) {
+                    return 0;
+                }
+                child = tape_next(child);
+            }
+            if (check_tape_value(child, tape_len) != tape_next(child).at) {
+                return 0;
+            }
+            child = tape_next(child);
+        }
+        if (child.at != close || !tape_at_end(child)) {
+            return 0;
+        }
+        next = close + 1;
+    } break;
+
+    case J_STRING: {
+        byte_slice string = tape_string(it);
+        if (it.at + 1 >= tape_len || string.at == NULL ||
+            string.at[string.len] != '\0') {
+            return 0;
+        }
+        next = it.at + 2;
+    } break;
+
+    case J_NUMBER: {
+        number_kind_t kind =
+            (number_kind_t)(TAPE_PAYLOAD(word) >> TAPE_NUMBER_SHIFT);
+        if (it.at + 1 >= tape_len || kind < NUMBER_I64 || kind > NUMBER_F64 ||
+            tape_number(it).kind != kind) {
+            return 0;
+        }
+        next = it.at + 2;
+    } break;
+
+    case J_TRUE:
+    case J_FALSE:
+    case J_NULL:
+        if (TAPE_PAYLOAD(word) != 0) {
+            return 0;
+        }
+        break;
+
+    default:
+        return 0;
+    }
+
+    return tape_next(it).at == next ? next : 0;
+}
+
+// the root is the parsed value and the walk from it ends at `tape_len`
+static bool check_tape(agnes_parser_t const *parser, agnes_result_t result) {
+    if (result.kind != RES_PARSER_SOME) {
+        return parser->tape_len == 0;
+    }
+    tape_iter_t root = tape_root(parser);
+    return parser->tape_len > 0 && tape_kind(root) == result.jvalue &&
+           check_tape_value(root, parser->tape_len) == parser->tape_len;
+}
+
+// agnes_feed `chunk_size` bytes at a time, each chunk copied on its own so
+// nothing can be read past it
+static agnes_result_t parse_streamed(u8 const *bytes, size_t size,
+                                     size_t chunk_size) {
+    agnes_stream_t stream = {0};
+    stream.filename = "stream";
+    stream.string_allocator =
+        (allocator_t){.alloc = stupid_alloc, .free = stupid_free};
+    u8 *chunk;
+    if (!stupid_alloc(chunk_size, &chunk) || !agnes_begin(&stream)) {
+        panic("unable to start streaming");
+    }
+
+    for (size_t at = 0; at < size; at += chunk_size) {
+        size_t len = size - at < chunk_size ? size - at : chunk_size;
+        memcpy(chunk, bytes + at, len);
+        if (agnes_feed(&stream, chunk, len).kind != RES_NONE) {
+            break;
+        }
+    }
+    stupid_free(chunk);
+    return agnes_finish(&stream);
+}
+
+// The file three times over as NDJSON, with tapes: every record must agree
+// with parse_json and have a well-formed tape.
+static bool check_batch(u8 const *bytes, size_t size, bool expected,
+                        size_t shard_count) {
+    size_t const count = 3;
+    u8 *lines;
+    if (!stupid_alloc(count * (size + 1), &lines)) {
+        panic("unable to allocate the records");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(lines + i * (size + 1), bytes, size);
+        lines[i * (size + 1) + size] = '\n';
+    }
+
+    agnes_result_t results[3];
+    agnes_batch_t batch = {0};
+    batch.bytes = lines;
+    batch.size = count * (size + 1);
+    batch.string_allocator =
+        (allocator_t){.alloc = stupid_alloc, .free = stupid_free};
+    batch.threads = 2;
+    batch.tapes = true;
+    batch.shard_count = shard_count;
+    batch.results = results;
+    batch.max_results = count;
+
+    bool ok = parse_ndjson(&batch).kind == RES_NONE &&
+              batch.record_count == count;
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = accepted(results[i]) == expected;
+        if (ok && results[i].kind == RES_PARSER_SOME) {
+            size_t tape_len;
+            tape_iter_t root = batch_tape(&batch, i, &tape_len);
+            ok = tape_kind(root) == results[i].jvalue &&
+                 check_tape_value(root, tape_len) == tape_len;
+        }
+    }
+    agnes_batch_free(&batch);
+    stupid_free(lines);
+    return ok;
+}
+
+// Streaming, `tokens == NULL` and parse_ndjson must accept and reject the
+// same inputs as parse_json. Streams and batches do not validate UTF-8, so
+// neither does the reference.
+static int check_consistency(agnes_parser_t *parser, char const *filename) {
+    parser->validate_utf8 = false;
+    agnes_result_t result = agnes_parse_file(parser, filename);
+    if (result.kind == RES_IO_ERROR) {
+        return EXIT_FAILURE;
+    }
+    bool expected = accepted(result);
+
+    agnes_parser_t fused = *parser;
+    fused.tokens = NULL;
+    if (accepted(parse_json(&fused)) != expected) {
+        printf("%s: tokens == NULL disagrees with parse_json\n", filename);
+        return EXIT_FAILURE;
+    }
+
+    size_t const chunk_sizes[] = {1, 7};
+    for (size_t i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); ++i) {
+        result = parse_streamed(parser->bytes, parser->file_size,
+                                chunk_sizes[i]);
+        if (accepted(result) != expected) {
+            printf("%s: streaming %zu bytes at a time disagrees with "
+                   "parse_json\n",
+                   filename, chunk_sizes[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // a record is a line, so only files on one line can be one
+    if (memchr(parser->bytes, '\n', parser->file_size) == NULL) {
+        size_t const shard_counts[] = {0, 4};
+        for (size_t i = 0; i < 2; ++i) {
+            if (!check_batch(parser->bytes, parser->file_size, expected,
+                             shard_counts[i])) {
+                printf("%s: parse_ndjson with %zu shards disagrees with "
+                       "parse_json\n",
+                       filename, shard_counts[i]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+// arguments: [1]: filename, [2]: filesize (validated by test.py),
+// [3] (optional): "consistency" to compare the other ways of parsing with
+// parse_json instead, see check_consistency
 int main(int argc, char const *argv[]) {
     if (argc < 3) {
         panic("insufficient command line arguments");
@@ -24,38 +227,41 @@ int main(int argc, char const *argv[]) {
     char const *filename = argv[1];
     size_t file_size = atoi(argv[2]);
 
-    size_t pool_size = MiB(1000);
     size_t max_file_size = MiB(400);
 
     if (file_size > max_file_size) {
         panic("input file too big");
     }
 
-    u8 *reserved_memory_pool;
+    // no more than a token per byte, and one for the end
+    agnes_parser_t parser = {0};
+    parser.max_tokens = file_size + 1;
 
-    if (!stupid_alloc(pool_size, &reserved_memory_pool)) {
+    if (!stupid_alloc(parser.max_tokens * sizeof(packed_token_t),
+                      (u8 **)&parser.tokens)) {
+        panic("unable to allocate required memory at start up");
+    }
+    parser.max_tape = 2 * parser.max_tokens;
+    if (!stupid_alloc(parser.max_tape * sizeof(u64), (u8 **)&parser.tape)) {
         panic("unable to allocate required memory at start up");
     }
-
-    FILE *handle = fopen(filename, "r");
-    fread(reserved_memory_pool, 1, file_size, handle);
-
-    agnes_parser_t parser = {0};
-    parser.bytes = reserved_memory_pool;
-    parser.file_size = file_size;
-    parser.filename = filename;
-    parser.max_tokens = max_file_size / sizeof(token_t);
-
-    parser.tokens = (token_t *)(reserved_memory_pool + max_file_size);
-    parser.line_info = (size_t *)(reserved_memory_pool + 2 * max_file_size);
 
     parser.string_allocator =
         (allocator_t){.alloc = stupid_alloc, .free = stupid_free};
+    if (argc > 3 && strcmp(argv[3], "consistency") == 0) {
+        return check_consistency(&parser, filename);
+    }
 
-    agnes_result_t result = parse_json(&parser);
+    // the test suite expects invalid UTF-8 to be rejected
+    parser.validate_utf8 = true;
 
-    if (result.kind == RES_PARSER_ERROR || result.kind == RES_LEXER_ERROR ||
-        result.kind == RES_OUT_OF_SPACE) {
+    agnes_result_t result = agnes_parse_file(&parser, filename);
+
+    if (!accepted(result)) {
+        return EXIT_FAILURE;
+    }
+    if (!check_tape(&parser, result)) {
+        printf("%s: malformed tape\n", filename);
         return EXIT_FAILURE;
     }
 
@@ -11,6 +11,7 @@ argparser.add_argument('--build-only', action=argparse.BooleanOptionalAction, de
 argparser.add_argument('--cleanup', action=argparse.BooleanOptionalAction, default=False)
 argparser.add_argument('--top', type=str, default=None)
 argparser.add_argument("--restrict", type=str, default=None)
+argparser.add_argument('--consistency', action=argparse.BooleanOptionalAction, default=True)
 
 args = argparser.parse_args()
 
@@ -23,7 +24,7 @@ if os.name == "nt":
 else:
     exec = exec + ".out"
 
-headers = ["common.h", "parser.h", "interner.h"] 
+headers = ["common.h", "parser.h", "interner.h", "arena.h"] 
 
 if not os.path.exists("build"):
     os.mkdir("build")
@@ -89,6 +90,12 @@ def run_tests():
                     result = "Pass"
                 elif expect[i] ==False and proc.returncode !=0:
                     result = "Pass"
+
+                # streaming and tokens == NULL must agree with parse_json
+                if args.consistency:
+                    proc = subprocess.run([exec, paths[i], str(sizes[i]), "consistency"])
+                    if proc.returncode != 0:
+                        result = "Fail"
                 
                 simple_name = paths[i].name
                 output_log.write(f"{simple_name}, {result}\n")